@@ -1,8 +1,10 @@
 #include <fstream>
 #include <sstream>
+#include <cstring>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "MyMath/MyMath.h"
+#include "embedded_assets.h"
 
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -18,11 +20,22 @@ MyMath::vec3 g_translation(0.0f, 0.0f, 0.0f);
 float g_rotationX = 0.0f;
 float g_rotationY = 0.0f;
 
+std::string assetDir;
+
+std::string assetPath(const std::string& name) {
+    return assetDir.empty() ? name : assetDir + "/" + name;
+}
+
 std::string loadShaderFromFile(const std::string& filePath) {
+    const EmbeddedAsset* asset = findEmbeddedAsset(filePath);
+    if (asset != nullptr && assetDir.empty()) {
+        return std::string(reinterpret_cast<const char*>(asset->data), asset->size);
+    }
+
     std::ifstream shaderFile;
     shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try {
-        shaderFile.open(filePath);
+        shaderFile.open(assetPath(filePath));
         std::stringstream shaderStream;
         shaderStream << shaderFile.rdbuf();
         shaderFile.close();
@@ -109,7 +122,16 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--asset-dir") == 0 && i + 1 < argc) {
+            assetDir = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
@@ -136,9 +158,9 @@ int main() {
         return -1;
     }
 
-    std::string vertexShaderPath = "/home/Haipovich/dev/Projects/study/OpenGL/Lab1/src/shaders/shader.vert";
-    std::string wavyFragmentShaderPath = "/home/Haipovich/dev/Projects/study/OpenGL/Lab1/src/shaders/wavy.frag";
-    std::string circularFragmentShaderPath = "/home/Haipovich/dev/Projects/study/OpenGL/Lab1/src/shaders/circular.frag";
+    std::string vertexShaderPath = "shaders/shader.vert";
+    std::string wavyFragmentShaderPath = "shaders/wavy.frag";
+    std::string circularFragmentShaderPath = "shaders/circular.frag";
 
     std::string vertexShaderCode = loadShaderFromFile(vertexShaderPath);
     std::string wavyFragmentShaderCode = loadShaderFromFile(wavyFragmentShaderPath);
@@ -2,9 +2,11 @@
 #include <vector>
 #include <fstream>
 #include <sstream>
+#include <cstring>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "MyMath/MyMath.h"
+#include "embedded_assets.h"
 
 const unsigned int GRID_SIZE = 32;
 const float GRID_STEP = 0.1f;
@@ -20,11 +22,22 @@ MyMath::vec3 g_translation(0.0f, 0.0f, 0.0f);
 float g_rotationX = 0.0f;
 float g_rotationY = 0.0f;
 
+std::string assetDir;
+
+std::string assetPath(const std::string& name) {
+    return assetDir.empty() ? name : assetDir + "/" + name;
+}
+
 std::string loadShaderFromFile(const std::string& filePath) {
+    const EmbeddedAsset* asset = findEmbeddedAsset(filePath);
+    if (asset != nullptr && assetDir.empty()) {
+        return std::string(reinterpret_cast<const char*>(asset->data), asset->size);
+    }
+
     std::ifstream shaderFile;
     shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try {
-        shaderFile.open(filePath);
+        shaderFile.open(assetPath(filePath));
         std::stringstream shaderStream;
         shaderStream << shaderFile.rdbuf();
         shaderFile.close();
@@ -57,7 +70,16 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--asset-dir") == 0 && i + 1 < argc) {
+            assetDir = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
@@ -83,8 +105,8 @@ int main() {
         glfwTerminate();
         return -1;
     }
-    std::string vertexShaderCode = loadShaderFromFile("/home/Haipovich/dev/Projects/study/OpenGL/Lab3/src/shaders/shader.vert");
-    std::string fragmentShaderCode = loadShaderFromFile("/home/Haipovich/dev/Projects/study/OpenGL/Lab3/src/shaders/shader.frag");
+    std::string vertexShaderCode = loadShaderFromFile("shaders/shader.vert");
+    std::string fragmentShaderCode = loadShaderFromFile("shaders/shader.frag");
 
     const char* vertexShaderSource = vertexShaderCode.c_str();
     const char* fragmentShaderSource = fragmentShaderCode.c_str();
@@ -1,8 +1,10 @@
 #include <fstream>
 #include <sstream>
+#include <cstring>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "MyMath/MyMath.h"
+#include "embedded_assets.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -22,11 +24,22 @@ float g_rotationX = 0.0f;
 float g_rotationY = 0.0f;
 float g_blendFactor = 0.5f;
 
+std::string assetDir;
+
+std::string assetPath(const std::string& name) {
+    return assetDir.empty() ? name : assetDir + "/" + name;
+}
+
 std::string loadShaderFromFile(const std::string& filePath) {
+    const EmbeddedAsset* asset = findEmbeddedAsset(filePath);
+    if (asset != nullptr && assetDir.empty()) {
+        return std::string(reinterpret_cast<const char*>(asset->data), asset->size);
+    }
+
     std::ifstream shaderFile;
     shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try {
-        shaderFile.open(filePath);
+        shaderFile.open(assetPath(filePath));
         std::stringstream shaderStream;
         shaderStream << shaderFile.rdbuf();
         shaderFile.close();
@@ -43,7 +56,13 @@ GLuint loadTexture(const char* path) {
     glGenTextures(1, &textureID);
 
     int width, height, nrComponents;
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+    unsigned char* data = nullptr;
+    const EmbeddedAsset* asset = findEmbeddedAsset(path);
+    if (asset != nullptr && assetDir.empty()) {
+        data = stbi_load_from_memory(asset->data, static_cast<int>(asset->size), &width, &height, &nrComponents, 0);
+    } else {
+        data = stbi_load(assetPath(path).c_str(), &width, &height, &nrComponents, 0);
+    }
     if (data) {
         GLenum format;
         if (nrComponents == 1)
@@ -102,7 +121,16 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--asset-dir") == 0 && i + 1 < argc) {
+            assetDir = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
@@ -129,8 +157,8 @@ int main() {
         glfwTerminate();
         return -1;
     }
-    std::string vertexShaderCode = loadShaderFromFile("/home/Haipovich/dev/Projects/study/OpenGL/Lab3/src/shaders/shader.vert");
-    std::string fragmentShaderCode = loadShaderFromFile("/home/Haipovich/dev/Projects/study/OpenGL/Lab3/src/shaders/shader.frag");
+    std::string vertexShaderCode = loadShaderFromFile("shaders/shader.vert");
+    std::string fragmentShaderCode = loadShaderFromFile("shaders/shader.frag");
 
     const char* vertexShaderSource = vertexShaderCode.c_str();
     const char* fragmentShaderSource = fragmentShaderCode.c_str();
@@ -217,8 +245,8 @@ int main() {
     glEnable(GL_DEPTH_TEST);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    GLuint texture1 = loadTexture("/home/Haipovich/dev/Projects/study/OpenGL/Lab3/src/textures/texture1.jpg");
-    GLuint texture2 = loadTexture("/home/Haipovich/dev/Projects/study/OpenGL/Lab3/src/textures/texture2.jpg");
+    GLuint texture1 = loadTexture("textures/texture1.jpg");
+    GLuint texture2 = loadTexture("textures/texture2.jpg");
 
 
     while (!glfwWindowShouldClose(window)) {
@@ -0,0 +1,93 @@
+# Embeds files into the executable as constexpr byte arrays.
+#
+#   embed_assets(<target> BASE_DIR <dir> FILES <paths relative to BASE_DIR>...)
+#
+# generates <build>/generated/embedded_assets.h with one EmbeddedAsset entry per file, keyed by its
+# relative path. The header is regenerated whenever one of the files changes. The same file is run in
+# script mode to do the work.
+
+if(CMAKE_SCRIPT_MODE_FILE)
+    string(REPLACE "|" ";" EMBED_FILES "${FILES}")
+
+    # CMake regexes have no {n} repetition, so one output row of 16 bytes is spelled out.
+    set(row_pattern "")
+    foreach(column RANGE 15)
+        string(APPEND row_pattern "0x[0-9a-f][0-9a-f],")
+    endforeach()
+
+    set(arrays "")
+    set(entries "")
+    set(index 0)
+    foreach(file ${EMBED_FILES})
+        file(READ "${BASE_DIR}/${file}" content HEX)
+        file(SIZE "${BASE_DIR}/${file}" size)
+
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${content}")
+        string(REGEX REPLACE "(${row_pattern})" "\\1\n    " bytes "${bytes}")
+
+        # A trailing NUL (not counted in size) lets text assets be used as C strings.
+        string(APPEND arrays "inline constexpr unsigned char asset${index}[] = {\n    ${bytes}0x00\n};\n\n")
+        string(APPEND entries "    { \"${file}\", embedded_data::asset${index}, ${size} },\n")
+        math(EXPR index "${index} + 1")
+    endforeach()
+
+    file(WRITE "${OUTPUT}.tmp"
+"// Generated by cmake/EmbedAssets.cmake, do not edit.
+#ifndef EMBEDDED_ASSETS_H
+#define EMBEDDED_ASSETS_H
+
+#include <cstddef>
+#include <string_view>
+
+struct EmbeddedAsset {
+    std::string_view name;
+    const unsigned char* data;
+    std::size_t size;
+};
+
+namespace embedded_data {
+${arrays}}
+
+inline constexpr EmbeddedAsset EMBEDDED_ASSETS[] = {
+${entries}};
+
+inline const EmbeddedAsset* findEmbeddedAsset(std::string_view name) {
+    for (const EmbeddedAsset& asset : EMBEDDED_ASSETS) {
+        if (asset.name == name) return &asset;
+    }
+    return nullptr;
+}
+
+#endif
+")
+    file(RENAME "${OUTPUT}.tmp" "${OUTPUT}")
+    return()
+endif()
+
+set(EMBED_ASSETS_SCRIPT ${CMAKE_CURRENT_LIST_FILE})
+
+function(embed_assets target)
+    cmake_parse_arguments(EMBED "" "BASE_DIR" "FILES" ${ARGN})
+
+    set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/generated)
+    set(output ${output_dir}/embedded_assets.h)
+    file(MAKE_DIRECTORY ${output_dir})
+
+    set(inputs "")
+    foreach(file ${EMBED_FILES})
+        list(APPEND inputs ${EMBED_BASE_DIR}/${file})
+    endforeach()
+    list(LENGTH EMBED_FILES count)
+    string(REPLACE ";" "|" file_arg "${EMBED_FILES}")
+
+    add_custom_command(
+        OUTPUT ${output}
+        COMMAND ${CMAKE_COMMAND} -DBASE_DIR=${EMBED_BASE_DIR} -DFILES=${file_arg} -DOUTPUT=${output} -P ${EMBED_ASSETS_SCRIPT}
+        DEPENDS ${inputs} ${EMBED_ASSETS_SCRIPT}
+        COMMENT "Embedding ${count} assets into ${target}"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE ${output})
+    target_include_directories(${target} PRIVATE ${output_dir})
+    target_compile_definitions(${target} PRIVATE HAVE_EMBEDDED_ASSETS=1)
+endfunction()
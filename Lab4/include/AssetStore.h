@@ -0,0 +1,21 @@
+#ifndef ASSET_STORE_H
+#define ASSET_STORE_H
+
+#include <string>
+
+// Resolves asset names such as "shaders/surface.frag". A file under the override directory wins
+// (for editing shaders without rebuilding), then the copy embedded at build time, then the name
+// as a plain path relative to the working directory.
+class AssetStore {
+public:
+    static void setOverrideDirectory(const std::string& directory);
+    static const std::string& getOverrideDirectory();
+
+    static std::string load(const std::string& name);
+    static std::string diskPath(const std::string& name);
+
+private:
+    static std::string& overrideDirectory();
+};
+
+#endif
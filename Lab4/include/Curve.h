@@ -4,24 +4,43 @@
 #include <vector>
 #include <MyMath/vec3.h>
 #include "Shader.h"
+#include "RenderQueue.h"
 
 class Curve {
 public:
-    unsigned int VAO, VBO;
+    unsigned int VAO, VBO, EBO;
     std::vector<MyMath::vec3> curvePoints;
+    std::vector<float> arcLengths;
 
     Curve();
     ~Curve();
 
     void generateCurve(const std::vector<MyMath::vec3>& controlPoints, int segmentsPerControlPoint = 10);
-    
+    void updateRange(const std::vector<MyMath::vec3>& controlPoints, size_t first, size_t last);
+
+    float getLength() const;
+    float parameterAtLength(float length) const;
+    MyMath::vec3 pointAtLength(float length) const;
+    std::vector<MyMath::vec3> resampleUniform(float spacing) const;
+
+    static bool isTessellationSupported();
+    void setTessellationEnabled(bool enabled);
+    bool isTessellationEnabled() const;
+
     void setupBuffers();
     void updateBuffers();
-    void Draw(Shader& shader);
+    void submit(RenderQueue& queue, Shader& shader, GLintptr objectOffset, RenderPass pass = RenderPass::Overlay) const;
     void clearCurve();
 
 private:
     bool buffersGenerated = false;
+    size_t bufferCapacity = 0;
+    bool useTessellation = false;
+    std::vector<unsigned int> patchIndices;
+
+    void updateArcLengths(size_t firstPoint);
+    void updatePatchIndices();
+    void uploadRange(size_t first, size_t last);
 };
 
-#endif 
+#endif
@@ -0,0 +1,69 @@
+#ifndef EDIT_HISTORY_H
+#define EDIT_HISTORY_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <MyMath/vec3.h>
+
+enum class EditOp : uint8_t {
+    ADD,
+    MOVE,
+    REMOVE,
+    CLEAR
+};
+
+struct EditRecord {
+    EditOp op;
+    uint32_t index;
+    uint32_t count;
+    uint32_t payload;
+};
+
+class PointArena {
+public:
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    uint32_t push(const MyMath::vec3& point);
+    const MyMath::vec3& at(uint32_t offset) const;
+    MyMath::vec3& at(uint32_t offset);
+    void truncate(uint32_t newSize);
+    void clear();
+
+    uint32_t size() const;
+    size_t memoryUsage() const;
+
+private:
+    std::vector<std::unique_ptr<MyMath::vec3[]>> chunks;
+    uint32_t used = 0;
+};
+
+class EditHistory {
+public:
+    void recordAdd(size_t index, const MyMath::vec3& point);
+    void recordMove(size_t index, const MyMath::vec3& from, const MyMath::vec3& to);
+    void recordRemove(size_t index, const MyMath::vec3& point);
+    void recordClear(const std::vector<MyMath::vec3>& points);
+    void seal();
+
+    const EditRecord* undo();
+    const EditRecord* redo();
+    bool canUndo() const;
+    bool canRedo() const;
+
+    const MyMath::vec3& payload(const EditRecord& record, size_t i = 0) const;
+
+    void clear();
+    size_t size() const;
+    size_t memoryUsage() const;
+
+private:
+    std::vector<EditRecord> records;
+    PointArena arena;
+    size_t cursor = 0;
+    bool sealed = true;
+
+    EditRecord& beginRecord(EditOp op, size_t index, size_t count);
+};
+
+#endif
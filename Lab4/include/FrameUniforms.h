@@ -0,0 +1,92 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <cstddef>
+#include <vector>
+#include <MyMath/vec3.h>
+#include <MyMath/vec4.h>
+#include <MyMath/mat4.h>
+#include "Shader.h"
+#include "StreamBuffer.h"
+
+// Mirrors the std140 FrameData block declared in the shaders: vec3 members are padded to 16 bytes.
+struct FrameData {
+    MyMath::mat4 projection;
+    MyMath::mat4 view;
+    MyMath::vec3 lightPos;
+    float padding0 = 0.0f;
+    MyMath::vec3 lightColor;
+    float padding1 = 0.0f;
+    MyMath::vec3 viewPos;
+    float padding2 = 0.0f;
+};
+
+static_assert(sizeof(MyMath::mat4) == 64, "mat4 must be 16 tightly packed floats");
+static_assert(offsetof(FrameData, projection) == 0, "std140 offset of FrameData.projection");
+static_assert(offsetof(FrameData, view) == 64, "std140 offset of FrameData.view");
+static_assert(offsetof(FrameData, lightPos) == 128, "std140 offset of FrameData.lightPos");
+static_assert(offsetof(FrameData, lightColor) == 144, "std140 offset of FrameData.lightColor");
+static_assert(offsetof(FrameData, viewPos) == 160, "std140 offset of FrameData.viewPos");
+static_assert(sizeof(FrameData) == 176, "std140 size of FrameData");
+
+// Mirrors the std140 ObjectData block: the per-draw values, bound as a range of ObjectUniformBuffer.
+struct ObjectData {
+    MyMath::mat4 model;
+    MyMath::vec4 color;
+};
+
+static_assert(offsetof(ObjectData, model) == 0, "std140 offset of ObjectData.model");
+static_assert(offsetof(ObjectData, color) == 64, "std140 offset of ObjectData.objectColor");
+static_assert(sizeof(ObjectData) == 80, "std140 size of ObjectData");
+
+class FrameUniformBuffer {
+public:
+    static const GLuint BINDING_POINT = 0;
+    static constexpr const char* BLOCK_NAME = "FrameData";
+
+    unsigned int UBO;
+
+    FrameUniformBuffer();
+    ~FrameUniformBuffer();
+
+    void setupBuffers();
+    void update(const FrameData& data);
+    void attach(Shader& shader) const;
+    void validateLayout(const Shader& shader) const;
+
+private:
+    bool buffersGenerated = false;
+};
+
+// One frame's worth of ObjectData entries, each at an offset aligned for glBindBufferRange. Entries are
+// staged on the CPU and copied in one block into a stream buffer region before the draws that read them;
+// reset() fences that region once the frame's draws are issued.
+class ObjectUniformBuffer {
+public:
+    static const GLuint BINDING_POINT = 1;
+    static constexpr const char* BLOCK_NAME = "ObjectData";
+
+    StreamBuffer stream;
+
+    ObjectUniformBuffer();
+
+    void setupBuffers();
+    void reset();
+    GLintptr push(const ObjectData& data);
+    void upload();
+    void bind(GLintptr offset) const;
+    size_t size() const;
+
+    void attach(Shader& shader) const;
+    void validateLayout(const Shader& shader) const;
+
+private:
+    std::vector<unsigned char> staging;
+    GLsizeiptr stride = 0;
+    GLsizeiptr alignment = 256;
+    GLintptr baseOffset = 0;
+    size_t count = 0;
+    bool buffersGenerated = false;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <MyMath/vec3.h>
+#include <MyMath/vec4.h>
+#include <MyMath/mat4.h>
+
+struct BoundingBox {
+    MyMath::vec3 min;
+    MyMath::vec3 max;
+
+    BoundingBox transformed(const MyMath::mat4& model) const;
+};
+
+struct BoundingSphere {
+    MyMath::vec3 center;
+    float radius = 0.0f;
+
+    // The radius grows by the largest axis scale of the model matrix.
+    BoundingSphere transformed(const MyMath::mat4& model) const;
+};
+
+struct CullStats {
+    unsigned long tested = 0;
+    unsigned long visible = 0;
+    double milliseconds = 0.0;
+};
+
+// Six planes (left, right, bottom, top, near, far) pulled out of projection * view. Each plane is stored as
+// (normal, d) with the normal pointing inwards and normalized, so dot(normal, p) + d is a signed distance.
+class Frustum {
+public:
+    std::array<MyMath::vec4, 6> planes;
+
+    static Frustum fromMatrix(const MyMath::mat4& projectionView);
+
+    bool intersects(const BoundingSphere& sphere) const;
+    bool intersects(const BoundingBox& box) const;
+
+    static CullStats& stats();
+    static void resetStats();
+};
+
+// World-space spheres kept as separate x/y/z/radius arrays so the frustum test runs four at a time in SSE
+// registers (plain scalar code on other targets).
+class SphereBatch {
+public:
+    std::vector<float> x, y, z, radius;
+
+    void clear();
+    void reserve(size_t count);
+    void push(const BoundingSphere& sphere);
+    size_t size() const;
+
+    // Appends the indices of spheres that touch the frustum to visible and returns how many were added.
+    size_t cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+};
+
+#endif
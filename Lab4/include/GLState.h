@@ -0,0 +1,59 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+struct GLStateStats {
+    unsigned long issued = 0;
+    unsigned long skipped = 0;
+};
+
+// Shadow copy of the bindings the app touches, so a bind that would not change anything never reaches the driver.
+// All binds of these kinds must go through here; objects that are deleted must be forgotten, because GL
+// silently unbinds them and a recycled name would otherwise look already bound.
+class GLState {
+public:
+    static const int MAX_TEXTURE_UNITS = 16;
+
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vao);
+    static void bindBuffer(GLenum target, GLuint buffer);
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+    static void setEnabled(GLenum capability, bool enabled);
+
+    static void forgetProgram(GLuint program);
+    static void forgetVertexArray(GLuint vao);
+    static void forgetBuffer(GLuint buffer);
+    static void forgetTexture(GLuint texture);
+    static void invalidate();
+
+    static GLStateStats& stats();
+    static void resetStats();
+
+private:
+    static const GLuint UNKNOWN = 0xFFFFFFFFu;
+
+    struct Cache {
+        GLuint program = UNKNOWN;
+        GLuint vertexArray = UNKNOWN;
+        GLuint arrayBuffer = UNKNOWN;
+        GLuint elementBuffer = UNKNOWN;
+        GLuint uniformBuffer = UNKNOWN;
+        GLuint activeTexture = UNKNOWN;
+        GLuint textures[MAX_TEXTURE_UNITS];
+        GLenum textureTargets[MAX_TEXTURE_UNITS];
+        int depthTest = -1;
+        int blend = -1;
+
+        Cache();
+    };
+
+    static Cache& cache();
+    static GLuint* bufferSlot(GLenum target);
+    static bool update(GLuint& slot, GLuint value);
+};
+
+#endif
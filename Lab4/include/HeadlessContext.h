@@ -0,0 +1,26 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <string>
+
+// A GL context without a window or display server: EGL on Mesa's surfaceless platform (llvmpipe works),
+// falling back to the default EGL display with a 1x1 pbuffer. Only available when built with EGL.
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    bool create();
+    void destroy();
+    const std::string& getError() const;
+
+private:
+    void* display;
+    void* surface;
+    void* context;
+    std::string error;
+
+    bool createContext(int major, int minor);
+};
+
+#endif
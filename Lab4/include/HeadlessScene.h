@@ -0,0 +1,55 @@
+#ifndef HEADLESS_SCENE_H
+#define HEADLESS_SCENE_H
+
+#include <string>
+#include <vector>
+#include <MyMath/vec3.h>
+
+struct CameraKey {
+    MyMath::vec3 position;
+    MyMath::vec3 target;
+};
+
+struct FrameTimeSummary {
+    size_t frames = 0;
+    double minMs = 0.0;
+    double meanMs = 0.0;
+    double medianMs = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+// A scripted scene for --headless runs. The profile file holds one "x y" point per line in the same
+// coordinates as points clicked in the editor; the camera path holds "px py pz [tx ty tz]" keyframes
+// spread evenly over the run (target defaults to the origin). Without a path the camera orbits the surface.
+// --instances N draws N copies of the surface in one instanced draw instead of the single surface.
+class HeadlessScene {
+public:
+    int frames = 120;
+    int width = 1280;
+    int height = 720;
+    int segments = 32;
+    int instances = 0;
+    std::string profilePath;
+    std::string cameraPathFile;
+    std::string pngPrefix = "frame";
+    std::vector<int> pngFrames;
+
+    std::vector<MyMath::vec3> profile;
+    std::vector<CameraKey> cameraPath;
+
+    // Returns false without an error for options it does not know, and with one for a missing or bad value.
+    bool parseArgument(int argc, char* argv[], int& i, std::string& error);
+    bool load(std::string& error);
+
+    CameraKey cameraAt(int frame) const;
+    bool wantsPng(int frame) const;
+    std::string pngPath(int frame) const;
+
+    static std::vector<MyMath::vec3> defaultProfile();
+    static FrameTimeSummary summarize(std::vector<double> frameTimesMs);
+    static bool writeFrameTimes(const std::string& path, const std::vector<double>& frameTimesMs);
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "InputQueue.h"
+
+struct InputLogEntry {
+    uint32_t frame;
+    InputEvent event;
+};
+
+// Every input event a session applied, tagged with the index of the frame it was applied before. The file is
+// a small header plus one 20-byte record per event. Replaying feeds each frame's events back through an
+// InputQueue, so the frame loop consumes them exactly as it consumed the live ones.
+class InputLog {
+public:
+    unsigned int width = 0;
+    unsigned int height = 0;
+    uint32_t frames = 0;
+    std::vector<InputLogEntry> entries;
+
+    void record(uint32_t frame, const InputEvent& event);
+
+    // Queues the events of `frame`; returns false if the queue filled up first, in which case the caller
+    // drains it and calls again.
+    bool feed(uint32_t frame, InputQueue& queue);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path, std::string& error);
+
+private:
+    size_t replayed = 0;
+};
+
+#endif
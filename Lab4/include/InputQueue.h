@@ -0,0 +1,55 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class InputEventType : uint8_t {
+    CursorMove,
+    MouseButton,
+    Scroll,
+    Key
+};
+
+// code is the key or mouse button; x/y hold the cursor position (CursorMove, MouseButton) or the scroll offsets.
+struct InputEvent {
+    InputEventType type = InputEventType::CursorMove;
+    int code = 0;
+    int action = 0;
+    int mods = 0;
+    double x = 0.0;
+    double y = 0.0;
+};
+
+struct InputQueueStats {
+    unsigned long queued = 0;
+    unsigned long dropped = 0;
+};
+
+// Fixed-capacity single-producer/single-consumer ring: the GLFW callbacks only push, and the frame loop
+// drains everything once per frame, so a 1000 Hz mouse costs one camera update and one upload per frame.
+// When full, new events are dropped and counted; cursor events carry absolute positions, so a dropped
+// move loses no accumulated motion.
+class InputQueue {
+public:
+    static const size_t CAPACITY = 4096;
+
+    InputQueue();
+
+    bool push(const InputEvent& event);
+    bool pop(InputEvent& event);
+
+    static InputQueueStats& stats();
+    static void resetStats();
+
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    std::array<InputEvent, CAPACITY> events;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif
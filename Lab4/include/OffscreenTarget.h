@@ -0,0 +1,27 @@
+#ifndef OFFSCREEN_TARGET_H
+#define OFFSCREEN_TARGET_H
+
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+// Framebuffer object with an RGBA8 colour and a 24-bit depth renderbuffer, for rendering without a window.
+class OffscreenTarget {
+public:
+    unsigned int FBO, colorRBO, depthRBO;
+
+    OffscreenTarget();
+    ~OffscreenTarget();
+
+    bool setupBuffers(int width, int height);
+    void bind() const;
+    void readPixels(std::vector<unsigned char>& rgba) const;
+
+private:
+    int width = 0;
+    int height = 0;
+    bool buffersGenerated = false;
+};
+
+#endif
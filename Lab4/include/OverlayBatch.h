@@ -0,0 +1,63 @@
+#ifndef OVERLAY_BATCH_H
+#define OVERLAY_BATCH_H
+
+#include <vector>
+#include <MyMath/vec3.h>
+#include "Shader.h"
+#include "VertexLayout.h"
+#include "RenderQueue.h"
+
+struct OverlayVertex {
+    MyMath::vec3 Position;
+    unsigned char Color[4];
+};
+
+template <>
+struct VertexLayout<OverlayVertex> {
+    static constexpr std::array<VertexAttribute, 2> attributes = {
+        VERTEX_ATTRIBUTE(OverlayVertex, Position, 0, GL_FALSE),
+        VERTEX_ATTRIBUTE(OverlayVertex, Color, 1, GL_TRUE)
+    };
+};
+
+// Points and lines share one buffer: points from offset 0, lines from the end of the point capacity, so
+// either section can be re-sent without moving the other.
+class OverlayBatch {
+public:
+    unsigned int VAO, VBO;
+
+    OverlayBatch();
+    ~OverlayBatch();
+
+    void updatePoints(const std::vector<MyMath::vec3>& points, const MyMath::vec3& color, size_t first, size_t last);
+    void updateLineStrip(const std::vector<MyMath::vec3>& points, const MyMath::vec3& color, size_t first,
+                         size_t last);
+    void clearLines();
+
+    void setupBuffers();
+    void updateBuffers();
+    void submit(RenderQueue& queue, Shader& shader) const;
+
+private:
+    std::vector<OverlayVertex> pointVertices;
+    std::vector<OverlayVertex> lineVertices;
+    size_t pointCapacity = 0;
+    size_t lineCapacity = 0;
+    bool buffersGenerated = false;
+
+    struct DirtyRange {
+        bool dirty = false;
+        size_t begin = 0;
+        size_t end = 0;
+
+        void mark(size_t first, size_t last);
+    };
+    DirtyRange pointsDirty;
+    DirtyRange linesDirty;
+
+    void uploadRange(const std::vector<OverlayVertex>& vertices, size_t offset, DirtyRange& range);
+
+    static OverlayVertex makeVertex(const MyMath::vec3& position, const MyMath::vec3& color);
+};
+
+#endif
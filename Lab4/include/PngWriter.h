@@ -0,0 +1,14 @@
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <string>
+#include <vector>
+
+// Writes 8-bit RGBA images as PNG without a zlib dependency: the image data goes into stored
+// (uncompressed) deflate blocks, so files are large but every viewer reads them.
+class PngWriter {
+public:
+    static bool write(const std::string& path, int width, int height, const std::vector<unsigned char>& rgba);
+};
+
+#endif
@@ -3,28 +3,41 @@
 
 #include <vector>
 #include <MyMath/vec3.h>
-#include "Shader.h"
+#include "EditHistory.h"
 
 class PointSet {
 public:
     std::vector<MyMath::vec3> points;
-    unsigned int VAO, VBO;
-
-    PointSet();
-    ~PointSet();
 
     void addPoint(float x, float y);
     void addPoint(const MyMath::vec3& point);
+    void movePoint(size_t index, const MyMath::vec3& point);
+    void removePoint(size_t index);
     const std::vector<MyMath::vec3>& getPoints() const;
     size_t getNumPoints() const;
     void clearPoints();
+    long findNearestPoint(const MyMath::vec3& position, float maxDistance) const;
+
+    bool undo();
+    bool redo();
+    void endEdit();
+    void clearHistory();
+    const EditHistory& getHistory() const;
 
-    void setupBuffers();
-    void updateBuffers();
-    void Draw(Shader& shader);
+    bool isDirty() const;
+    size_t getFirstModified() const;
+    size_t getEndModified() const;
+    void markClean();
 
 private:
-    bool buffersGenerated = false;
+    bool dirty = false;
+    size_t dirtyBegin = 0;
+    size_t dirtyEnd = 0;
+    EditHistory history;
+
+    void markDirty(size_t first, size_t last);
+    void insertAt(size_t index, const MyMath::vec3& point);
+    void eraseAt(size_t index);
 };
 
-#endif 
+#endif
@@ -0,0 +1,20 @@
+#ifndef POLYLINE_SIMPLIFIER_H
+#define POLYLINE_SIMPLIFIER_H
+
+#include <vector>
+#include <MyMath/vec3.h>
+
+class PolylineSimplifier {
+public:
+    explicit PolylineSimplifier(float tolerance = 0.005f);
+
+    void setTolerance(float tolerance);
+    float getTolerance() const;
+
+    std::vector<MyMath::vec3> simplify(const std::vector<MyMath::vec3>& points) const;
+
+private:
+    float tolerance;
+};
+
+#endif
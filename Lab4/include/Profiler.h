@@ -0,0 +1,130 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+// Scoped CPU timers and GL_TIME_ELAPSED queries around the frame passes. Build with PROFILER_ENABLED=0
+// to compile every PROFILE_* macro out; when built in, nothing is recorded until Profiler::setEnabled(true).
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+class Profiler {
+public:
+    // GPU results are read back this many frames later, so reading them never stalls the pipeline.
+    static const int GPU_FRAME_LATENCY = 3;
+    static const size_t HISTORY_SAMPLES = 240;
+    static const size_t MAX_TRACE_EVENTS = 1000000;
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled; }
+    static void setTracePath(const std::string& path);
+    static void setSummaryInterval(double seconds);
+
+    static void beginFrame();
+    static void endFrame();
+    static void shutdown();
+
+    static double nowMicroseconds();
+    static void recordCpu(const char* name, double startUs, double endUs);
+    static bool beginGpu(const char* name, double cpuStartUs);
+    static void endGpu();
+
+    static void printSummary();
+    static bool writeTrace(const std::string& path);
+
+private:
+    struct TraceEvent {
+        const char* name;
+        double startUs;
+        double durationUs;
+        bool gpu;
+    };
+
+    struct GpuQuery {
+        const char* name = nullptr;
+        GLuint query = 0;
+        double cpuStartUs = 0.0;
+    };
+
+    struct FrameQueries {
+        std::vector<GpuQuery> queries;
+        size_t used = 0;
+    };
+
+    struct Series {
+        const char* name;
+        bool gpu;
+        std::vector<double> samples;
+        size_t next = 0;
+    };
+
+    struct State {
+        FrameQueries frames[GPU_FRAME_LATENCY];
+        int frameSlot = 0;
+        bool gpuActive = false;
+        bool gpuSupported = false;
+        bool inFrame = false;
+        bool started = false;
+        std::vector<TraceEvent> events;
+        std::vector<Series> series;
+        std::string tracePath;
+        double summaryInterval = 1.0;
+        double lastSummaryUs = 0.0;
+    };
+
+    static inline bool enabled = false;
+
+    static State& state();
+    static void collect(FrameQueries& frame);
+    static void addSample(const char* name, bool gpu, double durationUs);
+};
+
+// Times the enclosing scope on the CPU and, when gpu is set, with a GL_TIME_ELAPSED query. GPU queries cannot
+// nest, so a GPU scope inside another one is only timed on the CPU.
+class ProfileScope {
+public:
+    ProfileScope(const char* name, bool gpu) : name(name), active(Profiler::isEnabled()) {
+        if (!active) return;
+        startUs = Profiler::nowMicroseconds();
+        gpuActive = gpu && Profiler::beginGpu(name, startUs);
+    }
+
+    ~ProfileScope() {
+        if (!active) return;
+        if (gpuActive) Profiler::endGpu();
+        Profiler::recordCpu(name, startUs, Profiler::nowMicroseconds());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    bool active;
+    bool gpuActive = false;
+    double startUs = 0.0;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, false)
+#define PROFILE_GPU_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, true)
+#define PROFILE_FRAME_BEGIN() Profiler::beginFrame()
+#define PROFILE_FRAME_END() Profiler::endFrame()
+#define PROFILE_RECORD_CPU(name, startUs, endUs) \
+    do { if (Profiler::isEnabled()) Profiler::recordCpu(name, startUs, endUs); } while (0)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_FRAME_BEGIN() ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+#define PROFILE_RECORD_CPU(name, startUs, endUs) ((void)0)
+#endif
+
+#endif
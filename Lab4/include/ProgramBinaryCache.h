@@ -0,0 +1,37 @@
+#ifndef PROGRAM_BINARY_CACHE_H
+#define PROGRAM_BINARY_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+class ProgramBinaryCache {
+public:
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int stores = 0;
+    unsigned int rejected = 0;
+
+    explicit ProgramBinaryCache(const std::string& directory = defaultDirectory());
+
+    static std::string defaultDirectory();
+
+    bool isSupported() const;
+    const std::string& getDirectory() const;
+
+    uint64_t makeKey(std::string_view programDescription) const;
+    GLuint load(uint64_t key);
+    void store(uint64_t key, GLuint program);
+
+private:
+    std::string directory;
+    std::string driverId;
+    bool supported = false;
+
+    std::string pathForKey(uint64_t key) const;
+};
+
+#endif
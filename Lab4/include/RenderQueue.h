@@ -0,0 +1,68 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <vector>
+#include "Shader.h"
+#include "FrameUniforms.h"
+
+enum class RenderPass : uint8_t {
+    Opaque = 0,
+    Overlay = 1
+};
+
+// Everything one draw call needs. Per-draw uniforms live in the object buffer at objectOffset
+// (-1 when the program reads no ObjectData); per-program uniforms are set once per frame.
+struct DrawPacket {
+    Shader* shader = nullptr;
+    GLuint vertexArray = 0;
+    GLuint texture = 0;
+    GLintptr objectOffset = -1;
+    GLenum primitive = GL_TRIANGLES;
+    GLint patchVertices = 0;
+    bool indexed = false;
+    GLint first = 0;
+    GLsizei count = 0;
+    GLsizei instanceCount = 1;
+};
+
+struct RenderQueueStats {
+    unsigned long draws = 0;
+    unsigned long instances = 0;
+    unsigned long programChanges = 0;
+    unsigned long vertexArrayChanges = 0;
+    unsigned long objectBinds = 0;
+};
+
+// Draws are collected for the frame, sorted by a 64-bit key and then issued in order, so programs, VAOs
+// and object ranges change only when they have to. Key layout, high to low bits:
+//   pass (4) | program (16) | unused (16) | depth (28)
+// Opaque depth sorts front to back; overlay depth back to front. Equal keys keep submission order.
+class RenderQueue {
+public:
+    static const int PASS_COUNT = 2;
+
+    static uint64_t makeKey(RenderPass pass, GLuint program, float depth);
+
+    void clear();
+    void submit(const DrawPacket& packet, RenderPass pass, float depth = 0.0f);
+    void sort();
+    void execute(const ObjectUniformBuffer& objects);
+    size_t size() const;
+
+    static RenderQueueStats& stats();
+    static void resetStats();
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<DrawPacket> packets;
+    std::vector<SortEntry> order;
+
+    static RenderPass passOf(uint64_t key);
+};
+
+#endif
@@ -1,34 +1,85 @@
 #ifndef REVOLUTION_SURFACE_H
 #define REVOLUTION_SURFACE_H
 
+#include <stop_token>
 #include <vector>
 #include <MyMath/vec3.h>
+#include <MyMath/vec4.h>
 #include <MyMath/mat4.h>
 #include "Shader.h"
+#include "VertexLayout.h"
+#include "RenderQueue.h"
+#include "Frustum.h"
+#include "StreamBuffer.h"
 
 struct Vertex {
     MyMath::vec3 Position;
     MyMath::vec3 Normal;
 };
 
+template <>
+struct VertexLayout<Vertex> {
+    static constexpr std::array<VertexAttribute, 2> attributes = {
+        VERTEX_ATTRIBUTE(Vertex, Position, 0, GL_FALSE),
+        VERTEX_ATTRIBUTE(Vertex, Normal, 1, GL_FALSE)
+    };
+};
+
+// Per-copy data for instanced drawing; the model matrix takes four consecutive locations, one per column.
+struct SurfaceInstance {
+    MyMath::mat4 model;
+    MyMath::vec4 color;
+};
+
+template <>
+struct VertexLayout<SurfaceInstance> {
+    static constexpr std::array<VertexAttribute, 2> attributes = {
+        INSTANCE_ATTRIBUTE(SurfaceInstance, model, 2, GL_FALSE),
+        INSTANCE_ATTRIBUTE(SurfaceInstance, color, 6, GL_FALSE)
+    };
+};
+
 class RevolutionSurface {
 public:
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
     unsigned int VAO, VBO, EBO;
+    // Model-space bounds, recomputed by generateSurface().
+    BoundingBox bounds;
+    BoundingSphere boundingSphere;
+
+    // Filled on the CPU each frame and streamed by updateInstances(); drawn by submitInstanced(). Call
+    // instanceStream.endFrame() once the frame's draws are issued.
+    std::vector<SurfaceInstance> instances;
+    unsigned int instanceVAO;
+    StreamBuffer instanceStream;
 
     RevolutionSurface();
     ~RevolutionSurface();
 
-    void generateSurface(const std::vector<MyMath::vec3>& curvePoints, int numSegments, char axis = 'X');
+    // Returns false if stop was requested before the mesh was complete; the arrays are then partial.
+    bool generateSurface(const std::vector<MyMath::vec3>& curvePoints, int numSegments, char axis = 'X',
+                         std::stop_token stop = {});
+    // Takes a mesh generateSurface built elsewhere, along with the bounds it computed.
+    void setMesh(std::vector<Vertex>&& meshVertices, std::vector<unsigned int>&& meshIndices,
+                 const BoundingBox& meshBounds, const BoundingSphere& meshSphere);
     void calculateNormals();
 
+    static size_t vertexCount(size_t profilePoints, int numSegments);
+    static size_t triangleCount(size_t profilePoints, int numSegments);
+
     void setupBuffers();
-    void Draw(Shader& shader, const MyMath::mat4& modelMatrix);
+    void submit(RenderQueue& queue, Shader& shader, GLintptr objectOffset, float depth) const;
+    void updateInstances();
+    void submitInstanced(RenderQueue& queue, Shader& shader, float depth) const;
     void clearSurface();
 
 private:
     bool buffersGenerated = false;
+    bool instancesReady = false;
+
+    void setupInstanceArray(GLintptr instanceOffset);
+    void computeBounds();
 };
 
 #endif 
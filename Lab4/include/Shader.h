@@ -2,6 +2,9 @@
 #define SHADER_H
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -12,23 +15,127 @@
 #include <MyMath/vec3.h>
 #include <MyMath/mat4.h>
 
+#include "ProgramBinaryCache.h"
+#include "ShaderPreprocessor.h"
+
+// Uniform values are shadowed per program so unchanged set() calls never reach the driver.
+// Build with SHADER_SHADOW_UNIFORMS=0 to send every call, e.g. while inspecting a GL trace.
+#ifndef SHADER_SHADOW_UNIFORMS
+#define SHADER_SHADOW_UNIFORMS 1
+#endif
+
+template <typename T>
+struct UniformHandle {
+    GLint location = -1;
+
+    bool valid() const { return location >= 0; }
+};
+
+struct ShaderStats {
+    unsigned long uniformLookups = 0;
+    unsigned long uniformUploads = 0;
+    unsigned long uniformSkips = 0;
+};
+
 class Shader {
 public:
     GLuint Program;
-    Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const GLchar* geometryPath = nullptr);
+    Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const GLchar* geometryPath = nullptr,
+           const GLchar* tessControlPath = nullptr, const GLchar* tessEvaluationPath = nullptr,
+           const std::vector<ShaderDefine>& defines = {});
     void Use();
+
+    bool isLinkComplete() const;
+    void finishLinking();
+    static void finishLinking(std::vector<Shader*> shaders);
+    static bool enableParallelCompile();
     
-    void setBool(const std::string &name, bool value) const;
-    void setInt(const std::string &name, int value) const;
-    void setFloat(const std::string &name, float value) const;
-    void setVec2(const std::string &name, float x, float y) const;
-    void setVec3(const std::string &name, float x, float y, float z) const;
-    void setVec3(const std::string &name, const MyMath::vec3& value) const;
-    void setVec4(const std::string &name, float x, float y, float z, float w) const;
-    void setMat4(const std::string &name, const MyMath::mat4& mat) const;
+    void setBool(std::string_view name, bool value) const;
+    void setInt(std::string_view name, int value) const;
+    void setFloat(std::string_view name, float value) const;
+    void setVec2(std::string_view name, float x, float y) const;
+    void setVec3(std::string_view name, float x, float y, float z) const;
+    void setVec3(std::string_view name, const MyMath::vec3& value) const;
+    void setVec4(std::string_view name, float x, float y, float z, float w) const;
+    void setMat4(std::string_view name, const MyMath::mat4& mat) const;
+
+    template <typename T>
+    UniformHandle<T> getUniform(std::string_view name) const {
+        return UniformHandle<T>{ findUniform(name) };
+    }
+
+    void set(UniformHandle<bool> uniform, bool value) const;
+    void set(UniformHandle<int> uniform, int value) const;
+    void set(UniformHandle<float> uniform, float value) const;
+    void set(UniformHandle<float[2]> uniform, float x, float y) const;
+    void set(UniformHandle<MyMath::vec3> uniform, const MyMath::vec3& value) const;
+    void set(UniformHandle<MyMath::vec4> uniform, const MyMath::vec4& value) const;
+    void set(UniformHandle<MyMath::mat4> uniform, const MyMath::mat4& value) const;
+
+    GLint findUniform(std::string_view name) const;
+
+    bool bindUniformBlock(const char* blockName, GLuint bindingPoint);
+
+    std::vector<std::string> getSourcePaths() const;
+    const std::vector<std::string>& getDependencies() const;
+    std::vector<std::string> preprocessSources(std::vector<std::string>* fileDependencies = nullptr) const;
+    bool reload(const std::vector<std::string>& sources, const std::vector<std::string>& fileDependencies);
+
+    static void setBinaryCache(ProgramBinaryCache* cache);
+
+    static ShaderStats& stats();
+    static void resetStats();
 
 private:
+    struct ShaderStage {
+        GLenum type;
+        const char* label;
+        std::string path;
+        std::string source;
+    };
+
+    struct UniformSlot {
+        std::string name;
+        uint32_t hash = 0;
+        GLint location = -1;
+    };
+
+    struct PendingBuild {
+        GLuint program = 0;
+        std::vector<GLuint> shaders;
+        uint64_t cacheKey = 0;
+        bool fromCache = false;
+    };
+
+    struct UniformShadow {
+        float value[16];
+        bool valid = false;
+    };
+
+    struct BlockBinding {
+        std::string name;
+        GLuint bindingPoint;
+    };
+
+    std::vector<ShaderStage> stages;
+    std::vector<ShaderDefine> defines;
+    std::vector<std::string> dependencies;
+    std::vector<BlockBinding> blockBindings;
+    PendingBuild pendingBuild;
+    bool linkPending = false;
+    std::vector<UniformSlot> uniformSlots;
+    mutable std::vector<UniformShadow> uniformShadows;
+
+    static ProgramBinaryCache* binaryCache;
+
+    PendingBuild submitBuild();
+    void completeBuild(PendingBuild& build);
     void checkCompileErrors(GLuint shader, std::string type);
+    void reflectUniforms();
+    void insertUniform(std::string_view name, GLint location);
+    static uint32_t hashName(std::string_view name);
+    bool shadowChanged(GLint location, const void* value, size_t size) const;
+    bool directUpload() const;
 };
 
 #endif 
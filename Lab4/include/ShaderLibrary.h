@@ -0,0 +1,30 @@
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "Shader.h"
+
+struct ShaderVariant {
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string geometryPath;
+    std::string tessControlPath;
+    std::string tessEvaluationPath;
+    std::vector<ShaderDefine> defines;
+};
+
+// Owns one Shader per (file set, define set); asking for the same variant again returns the existing program.
+class ShaderLibrary {
+public:
+    Shader* get(const ShaderVariant& variant);
+
+    static std::string makeKey(const ShaderVariant& variant);
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<Shader>> shaders;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+
+struct ShaderDefine {
+    std::string name;
+    std::string value;
+};
+
+// Expands #include "file" (relative to the including file, each file at most once) and injects
+// #define lines right after #version. Every file gets its own #line source-string number,
+// matching its position in the dependency list.
+class ShaderPreprocessor {
+public:
+    static std::string process(const std::string& path, const std::vector<ShaderDefine>& defines,
+                               std::vector<std::string>* dependencies = nullptr);
+
+private:
+    static void expand(const std::string& path, size_t sourceIndex, const std::vector<ShaderDefine>* defines,
+                       std::vector<std::string>& included, std::string& output);
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "Shader.h"
+
+// Watches shader source files on a background thread (inotify on Linux, timestamp polling elsewhere).
+// Changed sources are read there; the GL work happens in applyPending(), which is a single atomic load
+// on the frame thread while nothing has changed.
+class ShaderWatcher {
+public:
+    ShaderWatcher();
+    ~ShaderWatcher();
+
+    void watch(Shader* shader);
+    bool start();
+    void stop();
+    bool isRunning() const;
+
+    int applyPending();
+
+private:
+    struct WatchedShader {
+        Shader* shader;
+        std::vector<std::string> paths;
+    };
+
+    struct PendingReload {
+        Shader* shader;
+        std::vector<std::string> sources;
+        std::vector<std::string> dependencies;
+    };
+
+    struct WatchedDirectory {
+        int descriptor;
+        std::string path;
+    };
+
+    // Once running, the watched paths and directories change on the frame thread after a reload, so both
+    // threads go through watchMutex.
+    std::vector<WatchedShader> shaders;
+    std::vector<WatchedDirectory> directories;
+    std::mutex watchMutex;
+    std::atomic<bool> pathsChanged;
+    std::vector<PendingReload> pending;
+    std::mutex pendingMutex;
+    std::atomic<bool> reloadReady;
+    std::atomic<bool> running;
+    std::thread worker;
+    int inotifyFd;
+
+    void run();
+    void runPolling();
+    void prepareReloads(const std::vector<std::string>& changedPaths);
+    void refreshPaths(Shader* shader);
+    void watchDirectoryOf(const std::string& path);
+};
+
+#endif
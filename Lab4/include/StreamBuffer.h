@@ -0,0 +1,72 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+struct StreamAllocation {
+    void* data = nullptr;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+};
+
+struct StreamBufferStats {
+    unsigned long allocations = 0;
+    unsigned long waits = 0;
+    unsigned long reallocations = 0;
+    double waitMilliseconds = 0.0;
+};
+
+// Ring allocator for data rewritten every frame. With GL_ARB_buffer_storage the buffer is persistently and
+// coherently mapped and split into REGION_COUNT regions, one per frame in flight; a fence placed after the
+// frame's draws guards each region, so a writer only waits when the GPU is REGION_COUNT frames behind.
+// Without it, allocations come from a CPU staging area that flush() uploads with one glBufferSubData into
+// an orphaned buffer.
+//
+// Frame protocol: allocate() (any number of times) -> write -> flush() -> draw -> endFrame(). Only the first
+// allocation of a frame may grow the buffer (the name changes, so bind `buffer` after allocating); a later
+// one that does not fit returns a null pointer.
+class StreamBuffer {
+public:
+    static const int REGION_COUNT = 3;
+
+    unsigned int buffer;
+
+    explicit StreamBuffer(GLenum target);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    StreamAllocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+    void flush();
+    void endFrame();
+    bool isPersistent() const;
+
+    static bool isPersistentSupported();
+    static void setPersistentAllowed(bool allowed);
+
+    static StreamBufferStats& stats();
+    static void resetStats();
+
+private:
+    GLenum target;
+    bool persistent = false;
+    bool buffersGenerated = false;
+    unsigned char* mapped = nullptr;
+    std::vector<unsigned char> staging;
+    GLsizeiptr regionSize = 0;
+    GLsizeiptr cursor = 0;
+    int region = 0;
+    GLsync fences[REGION_COUNT] = {};
+
+    static inline bool persistentAllowed = true;
+
+    void reallocate(GLsizeiptr minimumRegionSize);
+    void release();
+    void waitForRegion(int index);
+};
+
+#endif
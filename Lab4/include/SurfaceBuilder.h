@@ -0,0 +1,72 @@
+#ifndef SURFACE_BUILDER_H
+#define SURFACE_BUILDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+#include <MyMath/vec3.h>
+#include "RevolutionSurface.h"
+
+// Tessellates revolution surfaces on a worker thread. request() supersedes the previous job and cancels it
+// if it is still running; the finished arrays come back through a single lock-free slot that the render
+// thread polls with takeResult(), so the only work left on the render thread is the GL upload.
+class SurfaceBuilder {
+public:
+    struct Result {
+        uint64_t job = 0;
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        BoundingBox bounds;
+        BoundingSphere boundingSphere;
+        // Worker-side tessellation time on the Profiler clock; the render thread records it, as Profiler is
+        // not thread-safe.
+        double startUs = 0.0;
+        double endUs = 0.0;
+    };
+
+    SurfaceBuilder();
+    ~SurfaceBuilder();
+
+    // Runs on the worker thread after a result is published; set it before start().
+    void setOnFinished(std::function<void()> callback);
+    void start();
+    void stop();
+
+    uint64_t request(std::vector<MyMath::vec3> profile, int segments, char axis);
+    std::unique_ptr<Result> takeResult();
+    bool isBusy() const;
+
+    unsigned long cancelled() const;
+
+private:
+    struct Job {
+        uint64_t id = 0;
+        std::vector<MyMath::vec3> profile;
+        int segments = 0;
+        char axis = 'Y';
+        std::stop_token stop;
+    };
+
+    std::mutex jobMutex;
+    std::condition_variable_any jobReady;
+    Job pendingJob;
+    bool hasPendingJob = false;
+    std::stop_source runningJob;
+
+    std::atomic<Result*> finished;
+    std::atomic<uint64_t> latestJob;
+    std::atomic<uint64_t> deliveredJob;
+    std::atomic<unsigned long> cancelledJobs;
+    std::function<void()> onFinished;
+    std::jthread worker;
+
+    void run(std::stop_token stop);
+};
+
+#endif
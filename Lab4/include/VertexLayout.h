@@ -0,0 +1,161 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include <MyMath/vec3.h>
+#include <MyMath/vec4.h>
+#include <MyMath/mat4.h>
+
+class Shader;
+
+// GL component count and type of a C++ attribute member; add a specialization to support a new packed format.
+// Matrices take one attribute location per column (slots).
+template <typename T>
+struct AttributeFormat;
+
+template <>
+struct AttributeFormat<float> {
+    static constexpr GLint components = 1;
+    static constexpr GLenum type = GL_FLOAT;
+};
+
+template <>
+struct AttributeFormat<MyMath::vec3> {
+    static constexpr GLint components = 3;
+    static constexpr GLenum type = GL_FLOAT;
+};
+
+template <>
+struct AttributeFormat<MyMath::vec4> {
+    static constexpr GLint components = 4;
+    static constexpr GLenum type = GL_FLOAT;
+};
+
+template <>
+struct AttributeFormat<MyMath::mat4> {
+    static constexpr GLint components = 4;
+    static constexpr GLenum type = GL_FLOAT;
+    static constexpr GLuint slots = 4;
+};
+
+template <std::size_t N>
+struct AttributeFormat<float[N]> {
+    static constexpr GLint components = N;
+    static constexpr GLenum type = GL_FLOAT;
+};
+
+template <std::size_t N>
+struct AttributeFormat<unsigned char[N]> {
+    static constexpr GLint components = N;
+    static constexpr GLenum type = GL_UNSIGNED_BYTE;
+};
+
+template <std::size_t N>
+struct AttributeFormat<signed char[N]> {
+    static constexpr GLint components = N;
+    static constexpr GLenum type = GL_BYTE;
+};
+
+template <std::size_t N>
+struct AttributeFormat<unsigned short[N]> {
+    static constexpr GLint components = N;
+    static constexpr GLenum type = GL_UNSIGNED_SHORT;
+};
+
+template <std::size_t N>
+struct AttributeFormat<short[N]> {
+    static constexpr GLint components = N;
+    static constexpr GLenum type = GL_SHORT;
+};
+
+template <typename T>
+constexpr GLuint attributeSlots() {
+    if constexpr (requires { AttributeFormat<T>::slots; }) {
+        return AttributeFormat<T>::slots;
+    } else {
+        return 1;
+    }
+}
+
+struct VertexAttribute {
+    GLuint location;
+    const char* name;
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    std::size_t offset;
+    std::size_t size;
+    GLuint slots = 1;
+    GLuint divisor = 0;
+};
+
+// Describes one member of a vertex struct; its format follows the member's declared type.
+#define VERTEX_ATTRIBUTE_DIVISOR(VertexType, member, attributeLocation, isNormalized, attributeDivisor)   \
+    VertexAttribute{ attributeLocation, #member,                                                  \
+                     AttributeFormat<decltype(VertexType::member)>::components,                   \
+                     AttributeFormat<decltype(VertexType::member)>::type,                         \
+                     isNormalized, offsetof(VertexType, member), sizeof(VertexType::member),      \
+                     attributeSlots<decltype(VertexType::member)>(), attributeDivisor }
+
+#define VERTEX_ATTRIBUTE(VertexType, member, attributeLocation, isNormalized) \
+    VERTEX_ATTRIBUTE_DIVISOR(VertexType, member, attributeLocation, isNormalized, 0)
+
+// Advances once per instance instead of once per vertex.
+#define INSTANCE_ATTRIBUTE(VertexType, member, attributeLocation, isNormalized) \
+    VERTEX_ATTRIBUTE_DIVISOR(VertexType, member, attributeLocation, isNormalized, 1)
+
+// Specialize with `static constexpr std::array<VertexAttribute, N> attributes` next to each vertex struct.
+template <typename V>
+struct VertexLayout;
+
+// A tightly packed vec3 stream (point and curve buffers).
+template <>
+struct VertexLayout<MyMath::vec3> {
+    static constexpr std::array<VertexAttribute, 1> attributes = {
+        VertexAttribute{ 0, "Position", AttributeFormat<MyMath::vec3>::components,
+                         AttributeFormat<MyMath::vec3>::type, GL_FALSE, 0, sizeof(MyMath::vec3) }
+    };
+};
+
+template <typename V>
+constexpr bool vertexLayoutFits() {
+    const auto& attributes = VertexLayout<V>::attributes;
+    for (size_t i = 0; i < attributes.size(); ++i) {
+        if (attributes[i].offset + attributes[i].size > sizeof(V)) return false;
+        for (size_t j = i + 1; j < attributes.size(); ++j) {
+            if (attributes[i].location < attributes[j].location + attributes[j].slots &&
+                attributes[j].location < attributes[i].location + attributes[i].slots) return false;
+        }
+    }
+    return true;
+}
+
+void applyVertexAttributes(const VertexAttribute* attributes, size_t count, GLsizei stride, GLintptr baseOffset = 0);
+void validateVertexAttributes(const Shader& shader, const VertexAttribute* attributes, size_t count,
+                              const char* layoutName);
+
+// Sets up the attribute pointers of the bound VAO for an array of V starting baseOffset bytes into the bound
+// GL_ARRAY_BUFFER.
+template <typename V>
+void applyVertexLayout(GLintptr baseOffset = 0) {
+    static_assert(vertexLayoutFits<V>(), "vertex layout overruns its struct or reuses a location");
+    applyVertexAttributes(VertexLayout<V>::attributes.data(), VertexLayout<V>::attributes.size(),
+                          static_cast<GLsizei>(sizeof(V)), baseOffset);
+}
+
+// Checks the program's active vertex inputs against the layouts of all streams feeding it (e.g. a vertex
+// struct plus an instance struct); throws std::runtime_error on a mismatch.
+template <typename... Vs>
+void validateVertexLayout(const Shader& shader, const char* layoutName) {
+    std::vector<VertexAttribute> attributes;
+    (attributes.insert(attributes.end(), VertexLayout<Vs>::attributes.begin(), VertexLayout<Vs>::attributes.end()), ...);
+    validateVertexAttributes(shader, attributes.data(), attributes.size(), layoutName);
+}
+
+#endif
@@ -1,8 +1,8 @@
 #version 330 core
 out vec4 FragColor;
 
-uniform vec3 curveColor;
+#include "include/object_data.glsl"
 
 void main() {
-    FragColor = vec4(curveColor, 1.0);
+    FragColor = vec4(objectColor.rgb, 1.0);
 } 
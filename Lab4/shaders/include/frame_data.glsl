@@ -0,0 +1,8 @@
+// Per-frame values shared by every program; must match FrameData in FrameUniforms.h.
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 lightPos;
+    vec3 lightColor;
+    vec3 viewPos;
+};
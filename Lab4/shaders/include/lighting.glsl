@@ -0,0 +1,41 @@
+#include "frame_data.glsl"
+
+#ifndef AMBIENT_STRENGTH
+#define AMBIENT_STRENGTH 0.15
+#endif
+
+#ifndef SPECULAR_STRENGTH
+#define SPECULAR_STRENGTH 0.6
+#endif
+
+#ifndef SHININESS
+#define SHININESS 32.0
+#endif
+
+// Blinn-Phong against the FrameData light. FLAT_SHADING uses the triangle normal from
+// screen-space derivatives; NO_SPECULAR compiles the highlight out.
+vec3 shadeBlinnPhong(vec3 fragPos, vec3 normal, vec3 albedo) {
+#ifdef FLAT_SHADING
+    vec3 norm = normalize(cross(dFdx(fragPos), dFdy(fragPos)));
+    if (dot(norm, normal) < 0.0) norm = -norm;
+#else
+    vec3 norm = normalize(normal);
+#endif
+
+    vec3 ambient = AMBIENT_STRENGTH * lightColor * albedo;
+
+    vec3 lightDir = normalize(lightPos - fragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * lightColor * albedo;
+
+#ifdef NO_SPECULAR
+    return ambient + diffuse;
+#else
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), SHININESS);
+    vec3 specular = SPECULAR_STRENGTH * spec * lightColor;
+
+    return ambient + diffuse + specular;
+#endif
+}
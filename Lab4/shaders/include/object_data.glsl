@@ -0,0 +1,5 @@
+// Per-draw values, bound as a range of the object buffer; must match ObjectData in FrameUniforms.h.
+layout (std140) uniform ObjectData {
+    mat4 model;
+    vec4 objectColor;
+};
@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;
+
+out vec4 Color;
+
+#include "include/frame_data.glsl"
+
+#ifndef POINT_SIZE
+#define POINT_SIZE 5.0
+#endif
+
+void main() {
+    gl_Position = projection * view * vec4(aPos, 1.0);
+    gl_PointSize = POINT_SIZE;
+    Color = aColor;
+}
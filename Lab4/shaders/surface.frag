@@ -2,30 +2,12 @@
 
 in vec3 FragPos;
 in vec3 Normal;
+flat in vec3 Albedo;
 
 out vec4 FragColor;
 
-uniform vec3 lightPos;
-uniform vec3 lightColor;
-uniform vec3 objectColor;
-uniform vec3 viewPos;
+#include "include/lighting.glsl"
 
 void main() {
-    vec3 norm = normalize(Normal);
-
-    float ambientStrength = 0.15;
-    vec3 ambient = ambientStrength * lightColor * objectColor;
-
-    vec3 lightDir = normalize(lightPos - FragPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor * objectColor;
-
-    float specularStrength = 0.6;
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(norm, halfwayDir), 0.0), 32.0);
-    vec3 specular = specularStrength * spec * lightColor;
-
-    vec3 result = ambient + diffuse + specular;
-    FragColor = vec4(result, 1.0);
+    FragColor = vec4(shadeBlinnPhong(FragPos, Normal, Albedo), 1.0);
 }
@@ -2,16 +2,29 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
+// INSTANCED reads the transform and color per instance from the instance buffer instead of ObjectData.
+#ifdef INSTANCED
+layout (location = 2) in mat4 instanceModel;
+layout (location = 6) in vec4 instanceColor;
+#else
+#include "include/object_data.glsl"
+#endif
+
 out vec3 FragPos;
 out vec3 Normal;
+flat out vec3 Albedo;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "include/frame_data.glsl"
 
 uniform mat3 normalMatrix;
 
 void main() {
+#ifdef INSTANCED
+    mat4 model = instanceModel;
+    Albedo = instanceColor.rgb;
+#else
+    Albedo = objectColor.rgb;
+#endif
     gl_Position = projection * view * model * vec4(aPos, 1.0);
     FragPos = vec3(model * vec4(aPos, 1.0));
     
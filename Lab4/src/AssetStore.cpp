@@ -0,0 +1,56 @@
+#include "AssetStore.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef HAVE_EMBEDDED_ASSETS
+#include "embedded_assets.h"
+#endif
+
+namespace {
+    bool readFile(const std::string& path, std::string& content) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        std::stringstream stream;
+        stream << file.rdbuf();
+        content = stream.str();
+        return true;
+    }
+}
+
+std::string& AssetStore::overrideDirectory() {
+    static std::string directory;
+    return directory;
+}
+
+void AssetStore::setOverrideDirectory(const std::string& directory) {
+    overrideDirectory() = directory;
+}
+
+const std::string& AssetStore::getOverrideDirectory() {
+    return overrideDirectory();
+}
+
+std::string AssetStore::diskPath(const std::string& name) {
+    if (overrideDirectory().empty()) return name;
+    return (std::filesystem::path(overrideDirectory()) / name).generic_string();
+}
+
+// Throws std::ifstream::failure like the file loaders it replaces, so callers keep their error handling.
+std::string AssetStore::load(const std::string& name) {
+    std::string content;
+    if (!overrideDirectory().empty() && readFile(diskPath(name), content)) {
+        return content;
+    }
+
+#ifdef HAVE_EMBEDDED_ASSETS
+    if (const EmbeddedAsset* asset = findEmbeddedAsset(name)) {
+        return std::string(reinterpret_cast<const char*>(asset->data), asset->size);
+    }
+#endif
+
+    if (readFile(name, content)) {
+        return content;
+    }
+    throw std::ifstream::failure("asset not found: " + name);
+}
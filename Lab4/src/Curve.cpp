@@ -1,44 +1,169 @@
 #include "Curve.h"
 #include "Shader.h"
+#include "GLState.h"
+#include "VertexLayout.h"
 #include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
 
-Curve::Curve() : VAO(0), VBO(0), buffersGenerated(false) {}
+Curve::Curve() : VAO(0), VBO(0), EBO(0), buffersGenerated(false) {}
 
 Curve::~Curve() {
     if (buffersGenerated) {
         glDeleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        GLState::forgetVertexArray(VAO);
+        GLState::forgetBuffer(VBO);
+        GLState::forgetBuffer(EBO);
     }
 }
 
 void Curve::generateCurve(const std::vector<MyMath::vec3>& controlPoints, int segmentsPerControlPoint) {
     curvePoints.clear();
+    arcLengths.clear();
     if (controlPoints.size() < 2) {
         if (buffersGenerated) updateBuffers();
         return;
     }
 
     curvePoints = controlPoints;
+    updateArcLengths(0);
 
     if (buffersGenerated) updateBuffers();
 }
 
+// Mirrors an edit of controlPoints[first, last) (plus any change in size) without rebuilding the whole curve.
+void Curve::updateRange(const std::vector<MyMath::vec3>& controlPoints, size_t first, size_t last) {
+    if (controlPoints.size() < 2) {
+        clearCurve();
+        return;
+    }
+
+    first = std::min(first, curvePoints.size());
+    if (controlPoints.size() != curvePoints.size()) {
+        last = controlPoints.size();
+    } else {
+        last = std::min(std::max(last, first), controlPoints.size());
+    }
+
+    curvePoints.resize(controlPoints.size());
+    std::copy(controlPoints.begin() + first, controlPoints.begin() + last, curvePoints.begin() + first);
+    updateArcLengths(first);
+
+    if (buffersGenerated) {
+        uploadRange(first, last);
+    } else {
+        updateBuffers();
+    }
+}
+
+void Curve::updateArcLengths(size_t firstPoint) {
+    arcLengths.resize(curvePoints.size());
+    if (curvePoints.empty()) return;
+
+    if (firstPoint == 0) {
+        arcLengths[0] = 0.0f;
+        firstPoint = 1;
+    }
+    for (size_t i = firstPoint; i < curvePoints.size(); ++i) {
+        arcLengths[i] = arcLengths[i - 1] + (curvePoints[i] - curvePoints[i - 1]).length();
+    }
+}
+
+float Curve::getLength() const {
+    return arcLengths.empty() ? 0.0f : arcLengths.back();
+}
+
+// Returns a fractional point index: the integer part selects the segment, the fraction is the position inside it.
+float Curve::parameterAtLength(float length) const {
+    if (curvePoints.size() < 2) return 0.0f;
+    if (length <= 0.0f) return 0.0f;
+    if (length >= arcLengths.back()) return static_cast<float>(curvePoints.size() - 1);
+
+    auto it = std::upper_bound(arcLengths.begin(), arcLengths.end(), length);
+    size_t segment = static_cast<size_t>(it - arcLengths.begin()) - 1;
+    float segmentLength = arcLengths[segment + 1] - arcLengths[segment];
+    float t = segmentLength > 0.0f ? (length - arcLengths[segment]) / segmentLength : 0.0f;
+    return static_cast<float>(segment) + t;
+}
+
+MyMath::vec3 Curve::pointAtLength(float length) const {
+    if (curvePoints.empty()) return MyMath::vec3(0.0f);
+
+    float u = parameterAtLength(length);
+    size_t segment = std::min(static_cast<size_t>(u), curvePoints.size() - 1);
+    if (segment + 1 >= curvePoints.size()) return curvePoints.back();
+
+    float t = u - static_cast<float>(segment);
+    return curvePoints[segment] + (curvePoints[segment + 1] - curvePoints[segment]) * t;
+}
+
+// Keeps every point and splits each segment into equal pieces no longer than spacing, so corners survive.
+std::vector<MyMath::vec3> Curve::resampleUniform(float spacing) const {
+    if (curvePoints.size() < 2 || spacing <= 0.0f) return curvePoints;
+
+    std::vector<MyMath::vec3> samples;
+    for (size_t i = 0; i + 1 < curvePoints.size(); ++i) {
+        float start = arcLengths[i];
+        float segmentLength = arcLengths[i + 1] - start;
+        int pieces = std::max(1, static_cast<int>(std::ceil(segmentLength / spacing)));
+
+        samples.push_back(curvePoints[i]);
+        for (int k = 1; k < pieces; ++k) {
+            samples.push_back(pointAtLength(start + segmentLength * static_cast<float>(k) / static_cast<float>(pieces)));
+        }
+    }
+    samples.push_back(curvePoints.back());
+    return samples;
+}
+
+bool Curve::isTessellationSupported() {
+    return GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader;
+}
+
+void Curve::setTessellationEnabled(bool enabled) {
+    useTessellation = enabled && isTessellationSupported();
+    if (buffersGenerated) updateBuffers();
+}
+
+bool Curve::isTessellationEnabled() const {
+    return useTessellation;
+}
+
+// Each patch covers the segment between points i and i+1, with i-1 and i+2 as neighbours (clamped at the ends).
+void Curve::updatePatchIndices() {
+    patchIndices.clear();
+    if (curvePoints.size() < 2) return;
+
+    unsigned int last = static_cast<unsigned int>(curvePoints.size() - 1);
+    patchIndices.reserve(last * 4);
+    for (unsigned int i = 0; i < last; ++i) {
+        patchIndices.push_back(i > 0 ? i - 1 : 0);
+        patchIndices.push_back(i);
+        patchIndices.push_back(i + 1);
+        patchIndices.push_back(std::min(i + 2, last));
+    }
+}
+
 void Curve::setupBuffers() {
     if (curvePoints.empty()) return;
 
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
 
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(MyMath::vec3), curvePoints.data(), GL_DYNAMIC_DRAW);
+    bufferCapacity = curvePoints.size();
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MyMath::vec3), (void*)0);
-    glEnableVertexAttribArray(0);
+    if (useTessellation) updatePatchIndices();
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, patchIndices.size() * sizeof(unsigned int), patchIndices.data(), GL_DYNAMIC_DRAW);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    applyVertexLayout<MyMath::vec3>();
 
     buffersGenerated = true;
 }
@@ -52,25 +177,54 @@ void Curve::updateBuffers() {
         return;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    if (!curvePoints.empty()) {
-        glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(MyMath::vec3), curvePoints.data(), GL_DYNAMIC_DRAW);
-    } else {
-        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+    uploadRange(0, curvePoints.size());
+}
+
+void Curve::uploadRange(size_t first, size_t last) {
+    size_t previousPatchCount = patchIndices.size();
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (curvePoints.size() > bufferCapacity) {
+        bufferCapacity = std::max(curvePoints.size(), bufferCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(MyMath::vec3), nullptr, GL_DYNAMIC_DRAW);
+        first = 0;
+        last = curvePoints.size();
+    }
+    if (first < last) {
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(MyMath::vec3), (last - first) * sizeof(MyMath::vec3), curvePoints.data() + first);
+    }
+
+    if (useTessellation) {
+        updatePatchIndices();
+        if (patchIndices.size() != previousPatchCount) {
+            GLState::bindVertexArray(VAO);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, patchIndices.size() * sizeof(unsigned int), patchIndices.data(), GL_DYNAMIC_DRAW);
+        }
     }
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void Curve::Draw(Shader& shader) {
+void Curve::submit(RenderQueue& queue, Shader& shader, GLintptr objectOffset, RenderPass pass) const {
     if (curvePoints.empty() || !buffersGenerated) return;
-    shader.Use();
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(curvePoints.size()));
-    glBindVertexArray(0);
+
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.vertexArray = VAO;
+    packet.objectOffset = objectOffset;
+    if (useTessellation && !patchIndices.empty()) {
+        packet.primitive = GL_PATCHES;
+        packet.patchVertices = 4;
+        packet.indexed = true;
+        packet.count = static_cast<GLsizei>(patchIndices.size());
+    } else {
+        packet.primitive = GL_LINE_STRIP;
+        packet.count = static_cast<GLsizei>(curvePoints.size());
+    }
+    queue.submit(packet, pass);
 }
 
 void Curve::clearCurve(){
     curvePoints.clear();
+    arcLengths.clear();
     if(buffersGenerated){
         updateBuffers();
     }
@@ -0,0 +1,121 @@
+#include "EditHistory.h"
+
+uint32_t PointArena::push(const MyMath::vec3& point) {
+    if (used == chunks.size() * CHUNK_SIZE) {
+        chunks.push_back(std::make_unique<MyMath::vec3[]>(CHUNK_SIZE));
+    }
+    at(used) = point;
+    return used++;
+}
+
+const MyMath::vec3& PointArena::at(uint32_t offset) const {
+    return chunks[offset / CHUNK_SIZE][offset % CHUNK_SIZE];
+}
+
+MyMath::vec3& PointArena::at(uint32_t offset) {
+    return chunks[offset / CHUNK_SIZE][offset % CHUNK_SIZE];
+}
+
+// Chunks past the new end are kept allocated, so an undo/redo/edit cycle does not reallocate.
+void PointArena::truncate(uint32_t newSize) {
+    if (newSize < used) used = newSize;
+}
+
+void PointArena::clear() {
+    chunks.clear();
+    used = 0;
+}
+
+uint32_t PointArena::size() const {
+    return used;
+}
+
+size_t PointArena::memoryUsage() const {
+    return chunks.size() * CHUNK_SIZE * sizeof(MyMath::vec3) + chunks.capacity() * sizeof(chunks[0]);
+}
+
+EditRecord& EditHistory::beginRecord(EditOp op, size_t index, size_t count) {
+    if (cursor < records.size()) {
+        arena.truncate(records[cursor].payload);
+        records.resize(cursor);
+    }
+    records.push_back(EditRecord{ op, static_cast<uint32_t>(index), static_cast<uint32_t>(count), arena.size() });
+    cursor = records.size();
+    sealed = true;
+    return records.back();
+}
+
+void EditHistory::recordAdd(size_t index, const MyMath::vec3& point) {
+    beginRecord(EditOp::ADD, index, 1);
+    arena.push(point);
+}
+
+// Consecutive moves of the same point are merged until seal() is called, so a drag is a single undo step.
+void EditHistory::recordMove(size_t index, const MyMath::vec3& from, const MyMath::vec3& to) {
+    if (!sealed && cursor == records.size() && cursor > 0) {
+        const EditRecord& last = records.back();
+        if (last.op == EditOp::MOVE && last.index == index) {
+            arena.at(last.payload + 1) = to;
+            return;
+        }
+    }
+    beginRecord(EditOp::MOVE, index, 1);
+    arena.push(from);
+    arena.push(to);
+    sealed = false;
+}
+
+void EditHistory::recordRemove(size_t index, const MyMath::vec3& point) {
+    beginRecord(EditOp::REMOVE, index, 1);
+    arena.push(point);
+}
+
+void EditHistory::recordClear(const std::vector<MyMath::vec3>& points) {
+    beginRecord(EditOp::CLEAR, 0, points.size());
+    for (const auto& p : points) {
+        arena.push(p);
+    }
+}
+
+void EditHistory::seal() {
+    sealed = true;
+}
+
+const EditRecord* EditHistory::undo() {
+    if (!canUndo()) return nullptr;
+    sealed = true;
+    return &records[--cursor];
+}
+
+const EditRecord* EditHistory::redo() {
+    if (!canRedo()) return nullptr;
+    sealed = true;
+    return &records[cursor++];
+}
+
+bool EditHistory::canUndo() const {
+    return cursor > 0;
+}
+
+bool EditHistory::canRedo() const {
+    return cursor < records.size();
+}
+
+const MyMath::vec3& EditHistory::payload(const EditRecord& record, size_t i) const {
+    return arena.at(record.payload + static_cast<uint32_t>(i));
+}
+
+void EditHistory::clear() {
+    std::vector<EditRecord>().swap(records);
+    arena.clear();
+    cursor = 0;
+    sealed = true;
+}
+
+size_t EditHistory::size() const {
+    return records.size();
+}
+
+size_t EditHistory::memoryUsage() const {
+    return records.capacity() * sizeof(EditRecord) + arena.memoryUsage();
+}
@@ -0,0 +1,161 @@
+#include "FrameUniforms.h"
+#include "GLState.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+FrameUniformBuffer::FrameUniformBuffer() : UBO(0), buffersGenerated(false) {}
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+    if (buffersGenerated) {
+        glDeleteBuffers(1, &UBO);
+        GLState::forgetBuffer(UBO);
+    }
+}
+
+void FrameUniformBuffer::setupBuffers() {
+    glGenBuffers(1, &UBO);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, UBO);
+
+    buffersGenerated = true;
+}
+
+void FrameUniformBuffer::update(const FrameData& data) {
+    if (!buffersGenerated) setupBuffers();
+
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+}
+
+void FrameUniformBuffer::attach(Shader& shader) const {
+    if (shader.bindUniformBlock(BLOCK_NAME, BINDING_POINT)) {
+        validateLayout(shader);
+    }
+}
+
+// Checks the offsets the driver assigned to the block against the C++ struct, so a layout drift fails at startup.
+void FrameUniformBuffer::validateLayout(const Shader& shader) const {
+    GLuint blockIndex = glGetUniformBlockIndex(shader.Program, BLOCK_NAME);
+    if (blockIndex == GL_INVALID_INDEX) return;
+
+    GLint blockSize = 0;
+    glGetActiveUniformBlockiv(shader.Program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+    if (blockSize != static_cast<GLint>(sizeof(FrameData))) {
+        throw std::runtime_error("ERROR::FRAME_DATA_LAYOUT: block size " + std::to_string(blockSize) +
+                                 " != sizeof(FrameData) " + std::to_string(sizeof(FrameData)));
+    }
+
+    const GLchar* names[] = { "projection", "view", "lightPos", "lightColor", "viewPos" };
+    const GLint expected[] = {
+        static_cast<GLint>(offsetof(FrameData, projection)),
+        static_cast<GLint>(offsetof(FrameData, view)),
+        static_cast<GLint>(offsetof(FrameData, lightPos)),
+        static_cast<GLint>(offsetof(FrameData, lightColor)),
+        static_cast<GLint>(offsetof(FrameData, viewPos))
+    };
+    const GLsizei count = sizeof(names) / sizeof(names[0]);
+
+    GLuint indices[count];
+    GLint offsets[count];
+    glGetUniformIndices(shader.Program, count, names, indices);
+    for (GLsizei i = 0; i < count; ++i) {
+        if (indices[i] == GL_INVALID_INDEX) continue;
+        glGetActiveUniformsiv(shader.Program, 1, &indices[i], GL_UNIFORM_OFFSET, &offsets[i]);
+        if (offsets[i] != expected[i]) {
+            throw std::runtime_error(std::string("ERROR::FRAME_DATA_LAYOUT: ") + names[i] + " at offset " +
+                                     std::to_string(offsets[i]) + ", expected " + std::to_string(expected[i]));
+        }
+    }
+}
+
+ObjectUniformBuffer::ObjectUniformBuffer() : stream(GL_UNIFORM_BUFFER), buffersGenerated(false) {}
+
+void ObjectUniformBuffer::setupBuffers() {
+    GLint offsetAlignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    alignment = std::max(offsetAlignment, 1);
+    stride = (static_cast<GLsizeiptr>(sizeof(ObjectData)) + alignment - 1) / alignment * alignment;
+
+    buffersGenerated = true;
+    count = 0;
+}
+
+// Called after the frame's draws are issued.
+void ObjectUniformBuffer::reset() {
+    stream.endFrame();
+    count = 0;
+}
+
+// Returns the offset to bind for this entry.
+GLintptr ObjectUniformBuffer::push(const ObjectData& data) {
+    if (!buffersGenerated) setupBuffers();
+
+    GLintptr offset = static_cast<GLintptr>(count) * stride;
+    if (staging.size() < static_cast<size_t>(offset + stride)) {
+        staging.resize(static_cast<size_t>(offset + stride));
+    }
+    std::memcpy(staging.data() + offset, &data, sizeof(ObjectData));
+    ++count;
+    return offset;
+}
+
+// The offsets handed out by push() are relative to this frame's block; bind() adds where the block landed.
+void ObjectUniformBuffer::upload() {
+    if (count == 0) return;
+
+    GLsizeiptr bytes = static_cast<GLsizeiptr>(count) * stride;
+    StreamAllocation allocation = stream.allocate(bytes, alignment);
+    if (allocation.data == nullptr) return;
+    std::memcpy(allocation.data, staging.data(), static_cast<size_t>(bytes));
+    stream.flush();
+    baseOffset = allocation.offset;
+}
+
+void ObjectUniformBuffer::bind(GLintptr offset) const {
+    GLState::bindBufferRange(GL_UNIFORM_BUFFER, BINDING_POINT, stream.buffer, baseOffset + offset, sizeof(ObjectData));
+}
+
+size_t ObjectUniformBuffer::size() const {
+    return count;
+}
+
+void ObjectUniformBuffer::attach(Shader& shader) const {
+    if (shader.bindUniformBlock(BLOCK_NAME, BINDING_POINT)) {
+        validateLayout(shader);
+    }
+}
+
+void ObjectUniformBuffer::validateLayout(const Shader& shader) const {
+    GLuint blockIndex = glGetUniformBlockIndex(shader.Program, BLOCK_NAME);
+    if (blockIndex == GL_INVALID_INDEX) return;
+
+    GLint blockSize = 0;
+    glGetActiveUniformBlockiv(shader.Program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+    if (blockSize != static_cast<GLint>(sizeof(ObjectData))) {
+        throw std::runtime_error("ERROR::OBJECT_DATA_LAYOUT: block size " + std::to_string(blockSize) +
+                                 " != sizeof(ObjectData) " + std::to_string(sizeof(ObjectData)));
+    }
+
+    const GLchar* names[] = { "model", "objectColor" };
+    const GLint expected[] = {
+        static_cast<GLint>(offsetof(ObjectData, model)),
+        static_cast<GLint>(offsetof(ObjectData, color))
+    };
+    const GLsizei count = sizeof(names) / sizeof(names[0]);
+
+    GLuint indices[count];
+    glGetUniformIndices(shader.Program, count, names, indices);
+    for (GLsizei i = 0; i < count; ++i) {
+        if (indices[i] == GL_INVALID_INDEX) continue;
+        GLint offset = 0;
+        glGetActiveUniformsiv(shader.Program, 1, &indices[i], GL_UNIFORM_OFFSET, &offset);
+        if (offset != expected[i]) {
+            throw std::runtime_error(std::string("ERROR::OBJECT_DATA_LAYOUT: ") + names[i] + " at offset " +
+                                     std::to_string(offset) + ", expected " + std::to_string(expected[i]));
+        }
+    }
+}
@@ -0,0 +1,178 @@
+#include "Frustum.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_SSE 1
+#else
+#define FRUSTUM_SSE 0
+#endif
+
+namespace {
+
+float distance(const MyMath::vec4& plane, float x, float y, float z) {
+    return plane.x * x + plane.y * y + plane.z * z + plane.w;
+}
+
+}
+
+BoundingBox BoundingBox::transformed(const MyMath::mat4& model) const {
+    // Arvo's method: each output extent gathers the min/max contribution of every matrix element.
+    float inMin[3] = { min.x, min.y, min.z };
+    float inMax[3] = { max.x, max.y, max.z };
+    float outMin[3] = { model.m03, model.m13, model.m23 };
+    float outMax[3] = { model.m03, model.m13, model.m23 };
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            float element = model.data[column * 4 + row];
+            float a = element * inMin[column];
+            float b = element * inMax[column];
+            outMin[row] += std::min(a, b);
+            outMax[row] += std::max(a, b);
+        }
+    }
+
+    BoundingBox result;
+    result.min = MyMath::vec3(outMin[0], outMin[1], outMin[2]);
+    result.max = MyMath::vec3(outMax[0], outMax[1], outMax[2]);
+    return result;
+}
+
+BoundingSphere BoundingSphere::transformed(const MyMath::mat4& model) const {
+    MyMath::vec4 c = model * MyMath::vec4(center, 1.0f);
+    float scaleSquared = 0.0f;
+    for (int column = 0; column < 3; ++column) {
+        const MyMath::vec4& axis = model.cols[column];
+        scaleSquared = std::max(scaleSquared, axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    }
+
+    BoundingSphere result;
+    result.center = MyMath::vec3(c.x, c.y, c.z);
+    result.radius = radius * std::sqrt(scaleSquared);
+    return result;
+}
+
+// Gribb/Hartmann: with rows r0..r3 of the matrix, the planes are r3 +- r0, r3 +- r1 and r3 +- r2.
+Frustum Frustum::fromMatrix(const MyMath::mat4& m) {
+    auto row = [&](int r) {
+        return MyMath::vec4(m.data[r], m.data[4 + r], m.data[8 + r], m.data[12 + r]);
+    };
+    MyMath::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+    auto add = [](const MyMath::vec4& a, const MyMath::vec4& b, float sign) {
+        return MyMath::vec4(a.x + sign * b.x, a.y + sign * b.y, a.z + sign * b.z, a.w + sign * b.w);
+    };
+
+    Frustum frustum;
+    frustum.planes = { add(r3, r0, 1.0f), add(r3, r0, -1.0f), add(r3, r1, 1.0f),
+                       add(r3, r1, -1.0f), add(r3, r2, 1.0f), add(r3, r2, -1.0f) };
+    for (MyMath::vec4& plane : frustum.planes) {
+        float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        if (length > 0.0f) {
+            plane = MyMath::vec4(plane.x / length, plane.y / length, plane.z / length, plane.w / length);
+        }
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const {
+    for (const MyMath::vec4& plane : planes) {
+        if (distance(plane, sphere.center.x, sphere.center.y, sphere.center.z) < -sphere.radius) return false;
+    }
+    return true;
+}
+
+// Conservative: a box is only rejected when its corner furthest along a plane normal is still outside.
+bool Frustum::intersects(const BoundingBox& box) const {
+    for (const MyMath::vec4& plane : planes) {
+        float x = plane.x >= 0.0f ? box.max.x : box.min.x;
+        float y = plane.y >= 0.0f ? box.max.y : box.min.y;
+        float z = plane.z >= 0.0f ? box.max.z : box.min.z;
+        if (distance(plane, x, y, z) < 0.0f) return false;
+    }
+    return true;
+}
+
+CullStats& Frustum::stats() {
+    static CullStats cullStats;
+    return cullStats;
+}
+
+void Frustum::resetStats() {
+    stats() = CullStats{};
+}
+
+void SphereBatch::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void SphereBatch::reserve(size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    radius.reserve(count);
+}
+
+void SphereBatch::push(const BoundingSphere& sphere) {
+    x.push_back(sphere.center.x);
+    y.push_back(sphere.center.y);
+    z.push_back(sphere.center.z);
+    radius.push_back(sphere.radius);
+}
+
+size_t SphereBatch::size() const {
+    return x.size();
+}
+
+size_t SphereBatch::cull(const Frustum& frustum, std::vector<uint32_t>& visible) const {
+    auto start = std::chrono::steady_clock::now();
+    size_t count = size();
+    size_t before = visible.size();
+    visible.reserve(before + count);
+
+    size_t i = 0;
+#if FRUSTUM_SSE
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; ++p) {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    for (; i + 4 <= count; i += 4) {
+        __m128 cx = _mm_loadu_ps(&x[i]);
+        __m128 cy = _mm_loadu_ps(&y[i]);
+        __m128 cz = _mm_loadu_ps(&z[i]);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], cx), _mm_mul_ps(planeY[p], cy)),
+                                  _mm_add_ps(_mm_mul_ps(planeZ[p], cz), planeW[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negativeRadius));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) visible.push_back(static_cast<uint32_t>(i + lane));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        BoundingSphere sphere;
+        sphere.center = MyMath::vec3(x[i], y[i], z[i]);
+        sphere.radius = radius[i];
+        if (frustum.intersects(sphere)) visible.push_back(static_cast<uint32_t>(i));
+    }
+
+    size_t added = visible.size() - before;
+    CullStats& cullStats = Frustum::stats();
+    cullStats.tested += static_cast<unsigned long>(count);
+    cullStats.visible += static_cast<unsigned long>(added);
+    cullStats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return added;
+}
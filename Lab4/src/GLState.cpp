@@ -0,0 +1,144 @@
+#include "GLState.h"
+
+GLState::Cache::Cache() {
+    for (int i = 0; i < MAX_TEXTURE_UNITS; ++i) {
+        textures[i] = UNKNOWN;
+        textureTargets[i] = 0;
+    }
+}
+
+GLState::Cache& GLState::cache() {
+    static Cache state;
+    return state;
+}
+
+GLStateStats& GLState::stats() {
+    static GLStateStats stateStats;
+    return stateStats;
+}
+
+void GLState::resetStats() {
+    stats() = GLStateStats{};
+}
+
+bool GLState::update(GLuint& slot, GLuint value) {
+    if (slot == value) {
+        ++stats().skipped;
+        return false;
+    }
+    slot = value;
+    ++stats().issued;
+    return true;
+}
+
+GLuint* GLState::bufferSlot(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER: return &cache().arrayBuffer;
+        case GL_ELEMENT_ARRAY_BUFFER: return &cache().elementBuffer;
+        case GL_UNIFORM_BUFFER: return &cache().uniformBuffer;
+        default: return nullptr;
+    }
+}
+
+void GLState::useProgram(GLuint program) {
+    if (update(cache().program, program))
+        glUseProgram(program);
+}
+
+// The element buffer binding belongs to the VAO, so it is unknown again after every VAO switch.
+void GLState::bindVertexArray(GLuint vao) {
+    if (update(cache().vertexArray, vao)) {
+        glBindVertexArray(vao);
+        cache().elementBuffer = UNKNOWN;
+    }
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer) {
+    GLuint* slot = bufferSlot(target);
+    if (slot == nullptr) {
+        ++stats().issued;
+        glBindBuffer(target, buffer);
+    } else if (update(*slot, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+// Indexed bindings are not cached, but glBindBufferBase also changes the generic binding point.
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    ++stats().issued;
+    glBindBufferBase(target, index, buffer);
+    if (GLuint* slot = bufferSlot(target))
+        *slot = buffer;
+}
+
+void GLState::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    ++stats().issued;
+    glBindBufferRange(target, index, buffer, offset, size);
+    if (GLuint* slot = bufferSlot(target))
+        *slot = buffer;
+}
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    Cache& state = cache();
+    if (unit >= static_cast<GLuint>(MAX_TEXTURE_UNITS)) {
+        stats().issued += 2;
+        state.activeTexture = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        return;
+    }
+    if (state.textureTargets[unit] == target && state.textures[unit] == texture) {
+        ++stats().skipped;
+        return;
+    }
+    if (update(state.activeTexture, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+    ++stats().issued;
+    glBindTexture(target, texture);
+    state.textures[unit] = texture;
+    state.textureTargets[unit] = target;
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled) {
+    int* slot = nullptr;
+    if (capability == GL_DEPTH_TEST) slot = &cache().depthTest;
+    else if (capability == GL_BLEND) slot = &cache().blend;
+
+    if (slot != nullptr && *slot == static_cast<int>(enabled)) {
+        ++stats().skipped;
+        return;
+    }
+    if (slot != nullptr) *slot = static_cast<int>(enabled);
+    ++stats().issued;
+    if (enabled) glEnable(capability);
+    else glDisable(capability);
+}
+
+void GLState::forgetProgram(GLuint program) {
+    if (cache().program == program) cache().program = UNKNOWN;
+}
+
+void GLState::forgetVertexArray(GLuint vao) {
+    if (cache().vertexArray == vao) {
+        cache().vertexArray = UNKNOWN;
+        cache().elementBuffer = UNKNOWN;
+    }
+}
+
+void GLState::forgetBuffer(GLuint buffer) {
+    Cache& state = cache();
+    if (state.arrayBuffer == buffer) state.arrayBuffer = UNKNOWN;
+    if (state.elementBuffer == buffer) state.elementBuffer = UNKNOWN;
+    if (state.uniformBuffer == buffer) state.uniformBuffer = UNKNOWN;
+}
+
+void GLState::forgetTexture(GLuint texture) {
+    Cache& state = cache();
+    for (int i = 0; i < MAX_TEXTURE_UNITS; ++i) {
+        if (state.textures[i] == texture) state.textures[i] = UNKNOWN;
+    }
+}
+
+void GLState::invalidate() {
+    cache() = Cache{};
+}
@@ -0,0 +1,140 @@
+#include "HeadlessContext.h"
+#include <cstring>
+
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace {
+    bool hasExtension(const char* extensions, const char* name) {
+        if (!extensions) return false;
+        size_t length = std::strlen(name);
+        for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+            bool startsWord = p == extensions || p[-1] == ' ';
+            bool endsWord = p[length] == ' ' || p[length] == '\0';
+            if (startsWord && endsWord) return true;
+        }
+        return false;
+    }
+
+    EGLDisplay openDisplay() {
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless") &&
+            hasExtension(clientExtensions, "EGL_EXT_platform_base")) {
+            auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay) {
+                EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if (display != EGL_NO_DISPLAY) return display;
+            }
+        }
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+}
+#endif
+
+HeadlessContext::HeadlessContext() : display(nullptr), surface(nullptr), context(nullptr) {}
+
+HeadlessContext::~HeadlessContext() {
+    destroy();
+}
+
+const std::string& HeadlessContext::getError() const {
+    return error;
+}
+
+// Same version ladder as the windowed path: 4.1 core for tessellation, 3.3 core otherwise.
+bool HeadlessContext::create() {
+#ifdef HAVE_EGL
+    EGLDisplay eglDisplay = openDisplay();
+    EGLint major = 0, minor = 0;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+        error = "no EGL display could be initialized";
+        return false;
+    }
+    display = eglDisplay;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        error = "EGL implementation does not support desktop OpenGL";
+        destroy();
+        return false;
+    }
+    if (createContext(4, 1) || createContext(3, 3)) {
+        return true;
+    }
+    destroy();
+    return false;
+#else
+    error = "built without EGL";
+    return false;
+#endif
+}
+
+bool HeadlessContext::createContext(int major, int minor) {
+#ifdef HAVE_EGL
+    EGLDisplay eglDisplay = static_cast<EGLDisplay>(display);
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    eglChooseConfig(eglDisplay, configAttributes, &config, 1, &numConfigs);
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext eglContext = eglCreateContext(eglDisplay, numConfigs > 0 ? config : nullptr, EGL_NO_CONTEXT,
+                                             contextAttributes);
+    if (eglContext == EGL_NO_CONTEXT) {
+        error = "could not create an OpenGL " + std::to_string(major) + "." + std::to_string(minor) + " core context";
+        return false;
+    }
+    context = eglContext;
+
+    // Rendering goes to an FBO, so no default framebuffer is needed when surfaceless contexts are allowed.
+    if (eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+        return true;
+    }
+    if (numConfigs > 0) {
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        EGLSurface pbuffer = eglCreatePbufferSurface(eglDisplay, config, pbufferAttributes);
+        if (pbuffer != EGL_NO_SURFACE) {
+            surface = pbuffer;
+            if (eglMakeCurrent(eglDisplay, pbuffer, pbuffer, eglContext)) return true;
+            eglDestroySurface(eglDisplay, pbuffer);
+            surface = nullptr;
+        }
+    }
+    eglDestroyContext(eglDisplay, eglContext);
+    context = nullptr;
+    error = "could not make the EGL context current";
+    return false;
+#else
+    (void)major;
+    (void)minor;
+    return false;
+#endif
+}
+
+void HeadlessContext::destroy() {
+#ifdef HAVE_EGL
+    if (!display) return;
+    EGLDisplay eglDisplay = static_cast<EGLDisplay>(display);
+    eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context) eglDestroyContext(eglDisplay, static_cast<EGLContext>(context));
+    if (surface) eglDestroySurface(eglDisplay, static_cast<EGLSurface>(surface));
+    eglTerminate(eglDisplay);
+    display = nullptr;
+    surface = nullptr;
+    context = nullptr;
+#endif
+}
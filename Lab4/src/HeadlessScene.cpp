@@ -0,0 +1,218 @@
+#include "HeadlessScene.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+    bool readNumberLines(const std::string& path, std::vector<std::vector<float>>& rows) {
+        std::ifstream file(path);
+        if (!file) return false;
+
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) line.erase(comment);
+
+            std::istringstream stream(line);
+            std::vector<float> values;
+            float value;
+            while (stream >> value) values.push_back(value);
+            if (!values.empty()) rows.push_back(values);
+        }
+        return true;
+    }
+
+    bool parseInt(const std::string& text, int minimum, int& value) {
+        char* end = nullptr;
+        long parsed = std::strtol(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || parsed < minimum || parsed > INT_MAX) return false;
+        value = static_cast<int>(parsed);
+        return true;
+    }
+
+    const char* const SCENE_OPTIONS[] = { "--frames", "--size", "--profile", "--segments", "--instances",
+                                          "--camera-path", "--png-prefix", "--png-frames" };
+}
+
+// Consumes argv[i] (and its value) if it is a headless scene option.
+bool HeadlessScene::parseArgument(int argc, char* argv[], int& i, std::string& error) {
+    const char* option = argv[i];
+    if (std::none_of(std::begin(SCENE_OPTIONS), std::end(SCENE_OPTIONS),
+                     [option](const char* known) { return std::strcmp(option, known) == 0; })) {
+        return false;
+    }
+    if (i + 1 >= argc) {
+        error = std::string(option) + " needs a value";
+        return false;
+    }
+    const char* value = argv[i + 1];
+
+    bool valid = true;
+    if (std::strcmp(option, "--frames") == 0) {
+        valid = parseInt(value, 1, frames);
+    } else if (std::strcmp(option, "--size") == 0) {
+        const char* separator = std::strchr(value, 'x');
+        int w = 0, h = 0;
+        valid = separator != nullptr && parseInt(std::string(value, separator), 1, w) && parseInt(separator + 1, 1, h);
+        if (valid) {
+            width = w;
+            height = h;
+        }
+    } else if (std::strcmp(option, "--profile") == 0) {
+        profilePath = value;
+    } else if (std::strcmp(option, "--segments") == 0) {
+        valid = parseInt(value, 3, segments);
+    } else if (std::strcmp(option, "--instances") == 0) {
+        valid = parseInt(value, 0, instances);
+    } else if (std::strcmp(option, "--camera-path") == 0) {
+        cameraPathFile = value;
+    } else if (std::strcmp(option, "--png-prefix") == 0) {
+        pngPrefix = value;
+    } else if (std::strcmp(option, "--png-frames") == 0) {
+        std::stringstream list(value);
+        std::string item;
+        int frame = 0;
+        while (valid && std::getline(list, item, ',')) {
+            if (item == "last") {
+                pngFrames.push_back(-1);
+            } else if (!item.empty()) {
+                valid = parseInt(item, 0, frame);
+                if (valid) pngFrames.push_back(frame);
+            }
+        }
+    }
+    if (!valid) {
+        error = "Invalid value for " + std::string(option) + ": " + value;
+        return false;
+    }
+    ++i;
+    return true;
+}
+
+bool HeadlessScene::load(std::string& error) {
+    profile.clear();
+    cameraPath.clear();
+
+    if (profilePath.empty()) {
+        profile = defaultProfile();
+    } else {
+        std::vector<std::vector<float>> rows;
+        if (!readNumberLines(profilePath, rows)) {
+            error = "cannot read profile " + profilePath;
+            return false;
+        }
+        for (const std::vector<float>& row : rows) {
+            if (row.size() >= 2) profile.push_back(MyMath::vec3(row[0], row[1], 0.0f));
+        }
+        if (profile.size() < 2) {
+            error = "profile " + profilePath + " needs at least 2 points";
+            return false;
+        }
+    }
+
+    if (!cameraPathFile.empty()) {
+        std::vector<std::vector<float>> rows;
+        if (!readNumberLines(cameraPathFile, rows)) {
+            error = "cannot read camera path " + cameraPathFile;
+            return false;
+        }
+        for (const std::vector<float>& row : rows) {
+            if (row.size() < 3) continue;
+            CameraKey key;
+            key.position = MyMath::vec3(row[0], row[1], row[2]);
+            key.target = row.size() >= 6 ? MyMath::vec3(row[3], row[4], row[5]) : MyMath::vec3(0.0f);
+            cameraPath.push_back(key);
+        }
+        if (cameraPath.empty()) {
+            error = "camera path " + cameraPathFile + " has no keyframes";
+            return false;
+        }
+    }
+    return true;
+}
+
+CameraKey HeadlessScene::cameraAt(int frame) const {
+    float t = frames > 1 ? static_cast<float>(frame) / static_cast<float>(frames - 1) : 0.0f;
+
+    if (cameraPath.empty()) {
+        float angle = 2.0f * static_cast<float>(M_PI) * t;
+        return { MyMath::vec3(3.0f * std::sin(angle), 0.5f, 3.0f * std::cos(angle)), MyMath::vec3(0.0f) };
+    }
+    if (cameraPath.size() == 1) return cameraPath.front();
+
+    float u = t * static_cast<float>(cameraPath.size() - 1);
+    size_t key = std::min(static_cast<size_t>(u), cameraPath.size() - 2);
+    float f = u - static_cast<float>(key);
+    const CameraKey& a = cameraPath[key];
+    const CameraKey& b = cameraPath[key + 1];
+    return { a.position + (b.position - a.position) * f, a.target + (b.target - a.target) * f };
+}
+
+bool HeadlessScene::wantsPng(int frame) const {
+    for (int wanted : pngFrames) {
+        if (wanted == frame || (wanted < 0 && frame == frames - 1)) return true;
+    }
+    return false;
+}
+
+std::string HeadlessScene::pngPath(int frame) const {
+    char number[16];
+    std::snprintf(number, sizeof(number), "_%04d.png", frame);
+    return pngPrefix + number;
+}
+
+std::vector<MyMath::vec3> HeadlessScene::defaultProfile() {
+    std::vector<MyMath::vec3> points;
+    const int count = 24;
+    for (int i = 0; i < count; ++i) {
+        float y = -0.7f + 1.4f * static_cast<float>(i) / (count - 1);
+        float radius = 0.35f + 0.15f * std::sin(y * 4.0f) + 0.1f * y;
+        points.push_back(MyMath::vec3(radius, y, 0.0f));
+    }
+    return points;
+}
+
+FrameTimeSummary HeadlessScene::summarize(std::vector<double> frameTimesMs) {
+    FrameTimeSummary summary;
+    if (frameTimesMs.empty()) return summary;
+
+    std::sort(frameTimesMs.begin(), frameTimesMs.end());
+    auto percentile = [&](double p) {
+        size_t index = static_cast<size_t>(std::ceil(p * frameTimesMs.size())) - 1;
+        return frameTimesMs[std::min(index, frameTimesMs.size() - 1)];
+    };
+
+    double total = 0.0;
+    for (double ms : frameTimesMs) total += ms;
+
+    summary.frames = frameTimesMs.size();
+    summary.minMs = frameTimesMs.front();
+    summary.meanMs = total / frameTimesMs.size();
+    summary.medianMs = percentile(0.5);
+    summary.p95Ms = percentile(0.95);
+    summary.p99Ms = percentile(0.99);
+    summary.maxMs = frameTimesMs.back();
+    return summary;
+}
+
+// One "frame,ms" row per frame, for plotting or diffing two builds.
+bool HeadlessScene::writeFrameTimes(const std::string& path, const std::vector<double>& frameTimesMs) {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    file << "frame,ms\n";
+    for (size_t i = 0; i < frameTimesMs.size(); ++i) {
+        file << i << ',' << frameTimesMs[i] << '\n';
+    }
+    return static_cast<bool>(file);
+}
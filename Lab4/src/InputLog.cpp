@@ -0,0 +1,129 @@
+#include "InputLog.h"
+#include <cstring>
+#include <fstream>
+
+namespace {
+    const char LOG_MAGIC[4] = { 'L', '4', 'I', 'N' };
+    const uint32_t LOG_VERSION = 1;
+
+    struct LogHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t frames;
+        uint32_t count;
+    };
+
+    // Positions are stored as float: a fraction of a pixel is far below anything the editor resolves.
+    struct LogRecord {
+        uint32_t frame;
+        uint8_t type;
+        uint8_t action;
+        uint16_t mods;
+        int32_t code;
+        float x;
+        float y;
+    };
+    static_assert(sizeof(LogRecord) == 20, "input log records are expected to be packed");
+}
+
+void InputLog::record(uint32_t frame, const InputEvent& event) {
+    entries.push_back({ frame, event });
+    if (frame >= frames) frames = frame + 1;
+}
+
+bool InputLog::feed(uint32_t frame, InputQueue& queue) {
+    while (replayed < entries.size() && entries[replayed].frame <= frame) {
+        if (!queue.push(entries[replayed].event)) return false;
+        ++replayed;
+    }
+    return true;
+}
+
+bool InputLog::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    LogHeader header{};
+    std::memcpy(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+    header.version = LOG_VERSION;
+    header.width = width;
+    header.height = height;
+    header.frames = frames;
+    header.count = static_cast<uint32_t>(entries.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<LogRecord> records;
+    records.reserve(entries.size());
+    for (const InputLogEntry& entry : entries) {
+        const InputEvent& event = entry.event;
+        records.push_back({ entry.frame, static_cast<uint8_t>(event.type), static_cast<uint8_t>(event.action),
+                            static_cast<uint16_t>(event.mods), static_cast<int32_t>(event.code),
+                            static_cast<float>(event.x), static_cast<float>(event.y) });
+    }
+    file.write(reinterpret_cast<const char*>(records.data()),
+               static_cast<std::streamsize>(records.size() * sizeof(LogRecord)));
+    return static_cast<bool>(file);
+}
+
+bool InputLog::load(const std::string& path, std::string& error) {
+    entries.clear();
+    replayed = 0;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot read input log " + path;
+        return false;
+    }
+
+    LogHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 || header.version != LOG_VERSION) {
+        error = path + " is not an input log of this version";
+        return false;
+    }
+
+    // The count comes from the file, so it is checked against what the file holds before anything is allocated.
+    std::streamoff dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff remaining = file.tellg() - dataStart;
+    file.seekg(dataStart);
+    if (static_cast<uint64_t>(header.count) * sizeof(LogRecord) > static_cast<uint64_t>(remaining)) {
+        error = "input log " + path + " is truncated";
+        return false;
+    }
+
+    std::vector<LogRecord> records(header.count);
+    if (!file.read(reinterpret_cast<char*>(records.data()),
+                   static_cast<std::streamsize>(records.size() * sizeof(LogRecord)))) {
+        error = "input log " + path + " is truncated";
+        return false;
+    }
+
+    uint32_t previousFrame = 0;
+    entries.reserve(records.size());
+    for (const LogRecord& record : records) {
+        if (record.type > static_cast<uint8_t>(InputEventType::Key) || record.frame < previousFrame ||
+            record.frame >= header.frames) {
+            error = "input log " + path + " has an invalid record";
+            entries.clear();
+            return false;
+        }
+        previousFrame = record.frame;
+
+        InputEvent event;
+        event.type = static_cast<InputEventType>(record.type);
+        event.code = record.code;
+        event.action = record.action;
+        event.mods = record.mods;
+        event.x = record.x;
+        event.y = record.y;
+        entries.push_back({ record.frame, event });
+    }
+
+    width = header.width;
+    height = header.height;
+    frames = header.frames;
+    return true;
+}
@@ -0,0 +1,33 @@
+#include "InputQueue.h"
+
+InputQueue::InputQueue() : head(0), tail(0) {}
+
+bool InputQueue::push(const InputEvent& event) {
+    size_t write = head.load(std::memory_order_relaxed);
+    if (write - tail.load(std::memory_order_acquire) == CAPACITY) {
+        ++stats().dropped;
+        return false;
+    }
+    events[write & (CAPACITY - 1)] = event;
+    head.store(write + 1, std::memory_order_release);
+    ++stats().queued;
+    return true;
+}
+
+bool InputQueue::pop(InputEvent& event) {
+    size_t read = tail.load(std::memory_order_relaxed);
+    if (read == head.load(std::memory_order_acquire)) return false;
+    event = events[read & (CAPACITY - 1)];
+    tail.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+// GLFW runs its callbacks on the main thread, which also drains the queue, so plain counters suffice.
+InputQueueStats& InputQueue::stats() {
+    static InputQueueStats queueStats;
+    return queueStats;
+}
+
+void InputQueue::resetStats() {
+    stats() = InputQueueStats{};
+}
@@ -0,0 +1,56 @@
+#include "OffscreenTarget.h"
+#include <cstring>
+
+OffscreenTarget::OffscreenTarget() : FBO(0), colorRBO(0), depthRBO(0), buffersGenerated(false) {}
+
+OffscreenTarget::~OffscreenTarget() {
+    if (buffersGenerated) {
+        glDeleteFramebuffers(1, &FBO);
+        glDeleteRenderbuffers(1, &colorRBO);
+        glDeleteRenderbuffers(1, &depthRBO);
+    }
+}
+
+bool OffscreenTarget::setupBuffers(int targetWidth, int targetHeight) {
+    width = targetWidth;
+    height = targetHeight;
+
+    glGenFramebuffers(1, &FBO);
+    glGenRenderbuffers(1, &colorRBO);
+    glGenRenderbuffers(1, &depthRBO);
+    buffersGenerated = true;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void OffscreenTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glViewport(0, 0, width, height);
+}
+
+// Returns tightly packed RGBA rows, top row first (GL reads bottom-up).
+void OffscreenTarget::readPixels(std::vector<unsigned char>& rgba) const {
+    size_t rowSize = static_cast<size_t>(width) * 4;
+    rgba.resize(rowSize * height);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+    std::vector<unsigned char> row(rowSize);
+    for (int top = 0, bottom = height - 1; top < bottom; ++top, --bottom) {
+        unsigned char* a = rgba.data() + top * rowSize;
+        unsigned char* b = rgba.data() + bottom * rowSize;
+        std::memcpy(row.data(), a, rowSize);
+        std::memcpy(a, b, rowSize);
+        std::memcpy(b, row.data(), rowSize);
+    }
+}
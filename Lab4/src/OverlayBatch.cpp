@@ -0,0 +1,139 @@
+#include "OverlayBatch.h"
+#include "Shader.h"
+#include "GLState.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+
+OverlayBatch::OverlayBatch() : VAO(0), VBO(0) {}
+
+OverlayBatch::~OverlayBatch() {
+    if (buffersGenerated) {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        GLState::forgetVertexArray(VAO);
+        GLState::forgetBuffer(VBO);
+    }
+}
+
+OverlayVertex OverlayBatch::makeVertex(const MyMath::vec3& position, const MyMath::vec3& color) {
+    auto toByte = [](float c) {
+        return static_cast<unsigned char>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return OverlayVertex{ position, { toByte(color.x), toByte(color.y), toByte(color.z), 255 } };
+}
+
+// Mirrors an edit of points[first, last) (plus any change in count) into the point section, as
+// Curve::updateRange does for the curve.
+void OverlayBatch::updatePoints(const std::vector<MyMath::vec3>& points, const MyMath::vec3& color, size_t first,
+                                size_t last) {
+    first = std::min(first, pointVertices.size());
+    if (points.size() != pointVertices.size()) {
+        last = points.size();
+    } else {
+        last = std::min(std::max(last, first), points.size());
+    }
+
+    pointVertices.resize(points.size());
+    for (size_t i = first; i < last; ++i) {
+        pointVertices[i] = makeVertex(points[i], color);
+    }
+    pointsDirty.mark(first, last);
+}
+
+// The strip is stored as GL_LINES pairs, segment i being points i and i+1, so an edit of points[first, last)
+// rewrites segments first-1 up to last-1.
+void OverlayBatch::updateLineStrip(const std::vector<MyMath::vec3>& points, const MyMath::vec3& color, size_t first,
+                                   size_t last) {
+    size_t segments = points.size() < 2 ? 0 : points.size() - 1;
+    size_t previousSegments = lineVertices.size() / 2;
+    first = std::min(first, previousSegments + 1);
+    if (segments != previousSegments) {
+        last = points.size();
+    } else {
+        last = std::min(std::max(last, first), points.size());
+    }
+
+    size_t firstSegment = std::min(first > 0 ? first - 1 : 0, segments);
+    size_t lastSegment = std::min(last, segments);
+    lineVertices.resize(segments * 2);
+    for (size_t i = firstSegment; i < lastSegment; ++i) {
+        lineVertices[i * 2] = makeVertex(points[i], color);
+        lineVertices[i * 2 + 1] = makeVertex(points[i + 1], color);
+    }
+    linesDirty.mark(firstSegment * 2, lastSegment * 2);
+}
+
+void OverlayBatch::clearLines() {
+    lineVertices.clear();
+    linesDirty.mark(0, 0);
+}
+
+void OverlayBatch::DirtyRange::mark(size_t first, size_t last) {
+    if (!dirty) {
+        begin = first;
+        end = last;
+        dirty = true;
+    } else {
+        begin = std::min(begin, first);
+        end = std::max(end, last);
+    }
+}
+
+void OverlayBatch::setupBuffers() {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+
+    GLState::bindVertexArray(VAO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    applyVertexLayout<OverlayVertex>();
+
+    pointCapacity = 0;
+    lineCapacity = 0;
+    buffersGenerated = true;
+}
+
+void OverlayBatch::updateBuffers() {
+    if (!buffersGenerated) setupBuffers();
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (pointVertices.size() > pointCapacity || lineVertices.size() > lineCapacity) {
+        if (pointVertices.size() > pointCapacity) pointCapacity = std::max(pointVertices.size(), pointCapacity * 2);
+        if (lineVertices.size() > lineCapacity) lineCapacity = std::max(lineVertices.size(), lineCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, (pointCapacity + lineCapacity) * sizeof(OverlayVertex), nullptr, GL_DYNAMIC_DRAW);
+        pointsDirty.mark(0, pointVertices.size());
+        linesDirty.mark(0, lineVertices.size());
+    }
+
+    uploadRange(pointVertices, 0, pointsDirty);
+    uploadRange(lineVertices, pointCapacity, linesDirty);
+}
+
+void OverlayBatch::uploadRange(const std::vector<OverlayVertex>& vertices, size_t offset, DirtyRange& range) {
+    size_t first = std::min(range.begin, vertices.size());
+    size_t last = std::min(range.end, vertices.size());
+    if (range.dirty && first < last) {
+        glBufferSubData(GL_ARRAY_BUFFER, (offset + first) * sizeof(OverlayVertex),
+                        (last - first) * sizeof(OverlayVertex), vertices.data() + first);
+    }
+    range.dirty = false;
+}
+
+void OverlayBatch::submit(RenderQueue& queue, Shader& shader) const {
+    if (!buffersGenerated) return;
+
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.vertexArray = VAO;
+
+    packet.primitive = GL_POINTS;
+    packet.first = 0;
+    packet.count = static_cast<GLsizei>(pointVertices.size());
+    queue.submit(packet, RenderPass::Overlay);
+
+    packet.primitive = GL_LINES;
+    packet.first = static_cast<GLint>(pointCapacity);
+    packet.count = static_cast<GLsizei>(lineVertices.size());
+    queue.submit(packet, RenderPass::Overlay);
+}
@@ -1,22 +1,26 @@
 #include "PointSet.h"
-#include "Shader.h"
-#include <GL/glew.h>
+#include <algorithm>
 
-PointSet::PointSet() : VAO(0), VBO(0), buffersGenerated(false) {}
+void PointSet::addPoint(float x, float y) {
+    addPoint(MyMath::vec3(x, y, 0.0f));
+}
 
-PointSet::~PointSet() {
-    if (buffersGenerated) {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-    }
+void PointSet::addPoint(const MyMath::vec3& point) {
+    history.recordAdd(points.size(), point);
+    insertAt(points.size(), point);
 }
 
-void PointSet::addPoint(float x, float y) {
-    points.push_back(MyMath::vec3(x, y, 0.0f)); 
+void PointSet::movePoint(size_t index, const MyMath::vec3& point) {
+    if (index >= points.size()) return;
+    history.recordMove(index, points[index], point);
+    points[index] = point;
+    markDirty(index, index + 1);
 }
 
-void PointSet::addPoint(const MyMath::vec3& point) {
-    points.push_back(point);
+void PointSet::removePoint(size_t index) {
+    if (index >= points.size()) return;
+    history.recordRemove(index, points[index]);
+    eraseAt(index);
 }
 
 const std::vector<MyMath::vec3>& PointSet::getPoints() const {
@@ -28,55 +32,121 @@ size_t PointSet::getNumPoints() const {
 }
 
 void PointSet::clearPoints() {
+    if (!points.empty()) {
+        history.recordClear(points);
+    }
     points.clear();
-    if (buffersGenerated) {
-        updateBuffers();
+    markDirty(0, 0);
+}
+
+long PointSet::findNearestPoint(const MyMath::vec3& position, float maxDistance) const {
+    long nearest = -1;
+    float best = maxDistance * maxDistance;
+    for (size_t i = 0; i < points.size(); ++i) {
+        float d = (points[i] - position).lengthSquared();
+        if (d <= best) {
+            best = d;
+            nearest = static_cast<long>(i);
+        }
     }
+    return nearest;
 }
 
-void PointSet::setupBuffers() {
-    if (points.empty()) return;
+void PointSet::insertAt(size_t index, const MyMath::vec3& point) {
+    points.insert(points.begin() + index, point);
+    markDirty(index, points.size());
+}
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+void PointSet::eraseAt(size_t index) {
+    points.erase(points.begin() + index);
+    markDirty(index, points.size());
+}
 
-    glBindVertexArray(VAO);
+bool PointSet::undo() {
+    const EditRecord* record = history.undo();
+    if (!record) return false;
+
+    switch (record->op) {
+        case EditOp::ADD:
+            eraseAt(record->index);
+            break;
+        case EditOp::MOVE:
+            points[record->index] = history.payload(*record, 0);
+            markDirty(record->index, record->index + 1);
+            break;
+        case EditOp::REMOVE:
+            insertAt(record->index, history.payload(*record, 0));
+            break;
+        case EditOp::CLEAR:
+            points.resize(record->count);
+            for (size_t i = 0; i < record->count; ++i) {
+                points[i] = history.payload(*record, i);
+            }
+            markDirty(0, points.size());
+            break;
+    }
+    return true;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(MyMath::vec3), points.data(), GL_DYNAMIC_DRAW);
+bool PointSet::redo() {
+    const EditRecord* record = history.redo();
+    if (!record) return false;
+
+    switch (record->op) {
+        case EditOp::ADD:
+            insertAt(record->index, history.payload(*record, 0));
+            break;
+        case EditOp::MOVE:
+            points[record->index] = history.payload(*record, 1);
+            markDirty(record->index, record->index + 1);
+            break;
+        case EditOp::REMOVE:
+            eraseAt(record->index);
+            break;
+        case EditOp::CLEAR:
+            points.clear();
+            markDirty(0, 0);
+            break;
+    }
+    return true;
+}
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MyMath::vec3), (void*)0);
-    glEnableVertexAttribArray(0);
+void PointSet::endEdit() {
+    history.seal();
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+void PointSet::clearHistory() {
+    history.clear();
+}
 
-    buffersGenerated = true;
+const EditHistory& PointSet::getHistory() const {
+    return history;
 }
 
-void PointSet::updateBuffers() {
-    if (!buffersGenerated && !points.empty()) {
-        setupBuffers();
-        return;
-    }
-    if (!buffersGenerated && points.empty()){
-        return;
-    }
-    
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    if (!points.empty()) {
-        glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(MyMath::vec3), points.data(), GL_DYNAMIC_DRAW);
+void PointSet::markDirty(size_t first, size_t last) {
+    if (!dirty) {
+        dirtyBegin = first;
+        dirtyEnd = last;
+        dirty = true;
     } else {
-        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+        dirtyBegin = std::min(dirtyBegin, first);
+        dirtyEnd = std::max(dirtyEnd, last);
     }
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void PointSet::Draw(Shader& shader) {
-    if (points.empty() || !buffersGenerated) return;
+bool PointSet::isDirty() const {
+    return dirty;
+}
+
+size_t PointSet::getFirstModified() const {
+    return dirty ? std::min(dirtyBegin, points.size()) : points.size();
+}
 
-    shader.Use();
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(points.size()));
-    glBindVertexArray(0);
-} 
+size_t PointSet::getEndModified() const {
+    return dirty ? std::min(dirtyEnd, points.size()) : points.size();
+}
+
+// Called once the modified range has been mirrored into the curve and the overlay.
+void PointSet::markClean() {
+    dirty = false;
+}
@@ -0,0 +1,67 @@
+#include "PolylineSimplifier.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+    float distanceToSegmentSquared(const MyMath::vec3& p, const MyMath::vec3& a, const MyMath::vec3& b) {
+        MyMath::vec3 ab = b - a;
+        MyMath::vec3 ap = p - a;
+        float abLengthSquared = ab.lengthSquared();
+        if (abLengthSquared <= 0.0f) return ap.lengthSquared();
+
+        float t = std::clamp(MyMath::dot(ap, ab) / abLengthSquared, 0.0f, 1.0f);
+        return (ap - ab * t).lengthSquared();
+    }
+}
+
+PolylineSimplifier::PolylineSimplifier(float tolerance) : tolerance(tolerance) {}
+
+void PolylineSimplifier::setTolerance(float value) {
+    tolerance = std::max(value, 0.0f);
+}
+
+float PolylineSimplifier::getTolerance() const {
+    return tolerance;
+}
+
+// Ramer-Douglas-Peucker with an explicit stack, so deep inputs cannot overflow the call stack.
+std::vector<MyMath::vec3> PolylineSimplifier::simplify(const std::vector<MyMath::vec3>& points) const {
+    if (points.size() < 3 || tolerance <= 0.0f) return points;
+
+    const float toleranceSquared = tolerance * tolerance;
+    std::vector<char> keep(points.size(), 0);
+    keep.front() = 1;
+    keep.back() = 1;
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.emplace_back(0, points.size() - 1);
+
+    while (!ranges.empty()) {
+        auto [first, last] = ranges.back();
+        ranges.pop_back();
+        if (last <= first + 1) continue;
+
+        float maxDistance = 0.0f;
+        size_t farthest = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            float d = distanceToSegmentSquared(points[i], points[first], points[last]);
+            if (d > maxDistance) {
+                maxDistance = d;
+                farthest = i;
+            }
+        }
+
+        if (maxDistance > toleranceSquared) {
+            keep[farthest] = 1;
+            ranges.emplace_back(first, farthest);
+            ranges.emplace_back(farthest, last);
+        }
+    }
+
+    std::vector<MyMath::vec3> result;
+    result.reserve(std::count(keep.begin(), keep.end(), 1));
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keep[i]) result.push_back(points[i]);
+    }
+    return result;
+}
@@ -0,0 +1,205 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+Profiler::State& Profiler::state() {
+    static State profilerState;
+    return profilerState;
+}
+
+void Profiler::setEnabled(bool enable) {
+    enabled = enable;
+}
+
+void Profiler::setTracePath(const std::string& path) {
+    state().tracePath = path;
+}
+
+// A non-positive interval only prints the summary once, at shutdown.
+void Profiler::setSummaryInterval(double seconds) {
+    state().summaryInterval = seconds;
+}
+
+double Profiler::nowMicroseconds() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::beginFrame() {
+    if (!enabled) return;
+    State& s = state();
+    if (!s.started) {
+        s.started = true;
+        s.gpuSupported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+        s.lastSummaryUs = nowMicroseconds();
+    }
+
+    // The slot about to be reused was recorded GPU_FRAME_LATENCY frames ago, so its results are normally ready.
+    s.frameSlot = (s.frameSlot + 1) % GPU_FRAME_LATENCY;
+    collect(s.frames[s.frameSlot]);
+    s.inFrame = true;
+}
+
+void Profiler::endFrame() {
+    if (!enabled) return;
+    State& s = state();
+    s.inFrame = false;
+
+    double now = nowMicroseconds();
+    if (s.summaryInterval > 0.0 && now - s.lastSummaryUs >= s.summaryInterval * 1e6) {
+        printSummary();
+        s.lastSummaryUs = now;
+    }
+}
+
+void Profiler::shutdown() {
+    State& s = state();
+    for (FrameQueries& frame : s.frames) {
+        collect(frame);
+        for (GpuQuery& query : frame.queries) {
+            glDeleteQueries(1, &query.query);
+        }
+        frame.queries.clear();
+    }
+    if (!enabled) return;
+
+    printSummary();
+    if (!s.tracePath.empty()) {
+        if (writeTrace(s.tracePath)) {
+            std::cout << "Wrote trace " << s.tracePath << " (" << s.events.size() << " events)" << std::endl;
+        } else {
+            std::cerr << "Failed to write trace " << s.tracePath << std::endl;
+        }
+    }
+}
+
+void Profiler::recordCpu(const char* name, double startUs, double endUs) {
+    State& s = state();
+    addSample(name, false, endUs - startUs);
+    if (!s.tracePath.empty() && s.events.size() < MAX_TRACE_EVENTS) {
+        s.events.push_back({ name, startUs, endUs - startUs, false });
+    }
+}
+
+bool Profiler::beginGpu(const char* name, double cpuStartUs) {
+    State& s = state();
+    if (!s.gpuSupported || s.gpuActive || !s.inFrame) return false;
+
+    FrameQueries& frame = s.frames[s.frameSlot];
+    if (frame.used == frame.queries.size()) {
+        GpuQuery query;
+        glGenQueries(1, &query.query);
+        frame.queries.push_back(query);
+    }
+    GpuQuery& query = frame.queries[frame.used++];
+    query.name = name;
+    query.cpuStartUs = cpuStartUs;
+    glBeginQuery(GL_TIME_ELAPSED, query.query);
+    s.gpuActive = true;
+    return true;
+}
+
+void Profiler::endGpu() {
+    glEndQuery(GL_TIME_ELAPSED);
+    state().gpuActive = false;
+}
+
+void Profiler::collect(FrameQueries& frame) {
+    State& s = state();
+    for (size_t i = 0; i < frame.used; ++i) {
+        const GpuQuery& query = frame.queries[i];
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(query.query, GL_QUERY_RESULT, &elapsedNs);
+
+        double durationUs = static_cast<double>(elapsedNs) / 1000.0;
+        addSample(query.name, true, durationUs);
+        if (!s.tracePath.empty() && s.events.size() < MAX_TRACE_EVENTS) {
+            s.events.push_back({ query.name, query.cpuStartUs, durationUs, true });
+        }
+    }
+    frame.used = 0;
+}
+
+void Profiler::addSample(const char* name, bool gpu, double durationUs) {
+    State& s = state();
+    Series* series = nullptr;
+    for (Series& candidate : s.series) {
+        if (candidate.gpu == gpu && (candidate.name == name || std::strcmp(candidate.name, name) == 0)) {
+            series = &candidate;
+            break;
+        }
+    }
+    if (!series) {
+        s.series.push_back({ name, gpu, {} });
+        series = &s.series.back();
+        series->samples.reserve(HISTORY_SAMPLES);
+    }
+
+    if (series->samples.size() < HISTORY_SAMPLES) {
+        series->samples.push_back(durationUs);
+    } else {
+        series->samples[series->next] = durationUs;
+    }
+    series->next = (series->next + 1) % HISTORY_SAMPLES;
+}
+
+void Profiler::printSummary() {
+    State& s = state();
+    if (s.series.empty()) return;
+
+    std::cout << "Profile (ms over the last " << HISTORY_SAMPLES << " samples):" << std::endl;
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::vector<double> sorted;
+    for (const Series& series : s.series) {
+        if (series.samples.empty()) continue;
+        sorted = series.samples;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) {
+            size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+            return sorted[index] / 1000.0;
+        };
+
+        std::cout << "  " << std::left << std::setw(20) << series.name << (series.gpu ? " gpu" : " cpu")
+                  << std::right << std::fixed << std::setprecision(3)
+                  << "  p50 " << std::setw(8) << percentile(0.50)
+                  << "  p95 " << std::setw(8) << percentile(0.95)
+                  << "  p99 " << std::setw(8) << percentile(0.99) << std::endl;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+// Chrome trace_event format: load the file in chrome://tracing or ui.perfetto.dev. GPU passes are placed at
+// the CPU time their query was issued, on their own track.
+bool Profiler::writeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    auto writeName = [&](const char* name) {
+        file << '"';
+        for (const char* c = name; *c; ++c) {
+            if (*c == '"' || *c == '\\') file << '\\';
+            file << *c;
+        }
+        file << '"';
+    };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    file << std::fixed << std::setprecision(3);
+    for (const TraceEvent& event : state().events) {
+        file << ",\n{\"name\":";
+        writeName(event.name);
+        file << ",\"cat\":\"" << (event.gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"ts\":" << event.startUs
+             << ",\"dur\":" << event.durationUs << ",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1) << "}";
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
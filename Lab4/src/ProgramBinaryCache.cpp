@@ -0,0 +1,178 @@
+#include "ProgramBinaryCache.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    const char CACHE_MAGIC[4] = { 'G', 'L', 'P', 'B' };
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t length;
+        uint64_t checksum;
+    };
+
+    uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string glString(GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory) : directory(directory) {
+    driverId = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+
+    GLint formats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    supported = formats > 0;
+
+    if (supported) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) {
+            std::cerr << "ProgramBinaryCache: cannot create " << directory << ": " << ec.message() << std::endl;
+            supported = false;
+        }
+    }
+}
+
+std::string ProgramBinaryCache::defaultDirectory() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return std::string(xdg) + "/OpenGLSurfaceApp/programs";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::string(home) + "/.cache/OpenGLSurfaceApp/programs";
+    }
+    return "shader_cache";
+}
+
+bool ProgramBinaryCache::isSupported() const {
+    return supported;
+}
+
+const std::string& ProgramBinaryCache::getDirectory() const {
+    return directory;
+}
+
+uint64_t ProgramBinaryCache::makeKey(std::string_view programDescription) const {
+    uint64_t hash = fnv1a(driverId.data(), driverId.size());
+    return fnv1a(programDescription.data(), programDescription.size(), hash);
+}
+
+std::string ProgramBinaryCache::pathForKey(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory + "/" + name;
+}
+
+GLuint ProgramBinaryCache::load(uint64_t key) {
+    if (!supported) return 0;
+
+    std::string path = pathForKey(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        ++misses;
+        return 0;
+    }
+
+    CacheHeader header{};
+    std::vector<char> binary;
+    bool valid = static_cast<bool>(file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+                 && std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0
+                 && header.version == CACHE_VERSION
+                 && header.key == key
+                 && header.length > 0;
+    if (valid) {
+        binary.resize(header.length);
+        valid = static_cast<bool>(file.read(binary.data(), header.length))
+                && fnv1a(binary.data(), binary.size()) == header.checksum;
+    }
+    file.close();
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (!program) {
+        ++rejected;
+        ++misses;
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return 0;
+    }
+    ++hits;
+    return program;
+}
+
+// Written to a temporary file first and renamed into place, so a crash never leaves a truncated entry behind.
+void ProgramBinaryCache::store(uint64_t key, GLuint program) {
+    if (!supported) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.key = key;
+    header.format = format;
+    header.length = static_cast<uint32_t>(length);
+    header.checksum = fnv1a(binary.data(), binary.size());
+
+    std::string path = pathForKey(key);
+    std::string tempPath = path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), binary.size());
+        if (!file) {
+            std::cerr << "ProgramBinaryCache: failed to write " << tempPath << std::endl;
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+    ++stores;
+}
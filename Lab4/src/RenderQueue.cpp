@@ -0,0 +1,118 @@
+#include "RenderQueue.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace {
+    const int PASS_SHIFT = 60;
+    const int PROGRAM_SHIFT = 44;
+    const uint64_t DEPTH_MAX = (1ull << 28) - 1;
+
+    const char* PASS_NAMES[RenderQueue::PASS_COUNT] = { "opaque pass", "overlay pass" };
+}
+
+// depth is expected in [0, 1] (view distance over the far plane) and is clamped.
+uint64_t RenderQueue::makeKey(RenderPass pass, GLuint program, float depth) {
+    depth = std::clamp(depth, 0.0f, 1.0f);
+    if (pass == RenderPass::Overlay) depth = 1.0f - depth;
+    uint64_t quantizedDepth = static_cast<uint64_t>(depth * static_cast<float>(DEPTH_MAX));
+
+    return (static_cast<uint64_t>(pass) << PASS_SHIFT) |
+           (static_cast<uint64_t>(program & 0xFFFFu) << PROGRAM_SHIFT) |
+           std::min(quantizedDepth, DEPTH_MAX);
+}
+
+RenderPass RenderQueue::passOf(uint64_t key) {
+    return static_cast<RenderPass>(key >> PASS_SHIFT);
+}
+
+void RenderQueue::clear() {
+    packets.clear();
+    order.clear();
+}
+
+void RenderQueue::submit(const DrawPacket& packet, RenderPass pass, float depth) {
+    if (packet.shader == nullptr || packet.count <= 0 || packet.instanceCount <= 0) return;
+
+    order.push_back({ makeKey(pass, packet.shader->Program, depth), static_cast<uint32_t>(packets.size()) });
+    packets.push_back(packet);
+}
+
+void RenderQueue::sort() {
+    std::sort(order.begin(), order.end(), [](const SortEntry& a, const SortEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.index < b.index;
+    });
+}
+
+size_t RenderQueue::size() const {
+    return packets.size();
+}
+
+void RenderQueue::execute(const ObjectUniformBuffer& objects) {
+    RenderQueueStats& queueStats = stats();
+    Shader* currentShader = nullptr;
+    GLuint currentVertexArray = 0;
+    GLintptr boundObject = -1;
+    GLint patchVertices = 0;
+
+    size_t begin = 0;
+    while (begin < order.size()) {
+        RenderPass pass = passOf(order[begin].key);
+        size_t end = begin;
+        while (end < order.size() && passOf(order[end].key) == pass) ++end;
+
+        PROFILE_GPU_SCOPE(PASS_NAMES[static_cast<int>(pass) % PASS_COUNT]);
+        for (size_t i = begin; i < end; ++i) {
+            const DrawPacket& packet = packets[order[i].index];
+
+            if (packet.shader != currentShader) {
+                packet.shader->Use();
+                currentShader = packet.shader;
+                ++queueStats.programChanges;
+            }
+            if (packet.vertexArray != currentVertexArray) {
+                GLState::bindVertexArray(packet.vertexArray);
+                currentVertexArray = packet.vertexArray;
+                ++queueStats.vertexArrayChanges;
+            }
+            if (packet.texture != 0) {
+                GLState::bindTexture(0, GL_TEXTURE_2D, packet.texture);
+            }
+            if (packet.objectOffset >= 0 && packet.objectOffset != boundObject) {
+                objects.bind(packet.objectOffset);
+                boundObject = packet.objectOffset;
+                ++queueStats.objectBinds;
+            }
+            if (packet.primitive == GL_PATCHES && packet.patchVertices != patchVertices) {
+                glPatchParameteri(GL_PATCH_VERTICES, packet.patchVertices);
+                patchVertices = packet.patchVertices;
+            }
+
+            void* indexOffset = (void*)(static_cast<size_t>(packet.first) * sizeof(unsigned int));
+            if (packet.instanceCount != 1) {
+                if (packet.indexed) {
+                    glDrawElementsInstanced(packet.primitive, packet.count, GL_UNSIGNED_INT, indexOffset,
+                                            packet.instanceCount);
+                } else {
+                    glDrawArraysInstanced(packet.primitive, packet.first, packet.count, packet.instanceCount);
+                }
+            } else if (packet.indexed) {
+                glDrawElements(packet.primitive, packet.count, GL_UNSIGNED_INT, indexOffset);
+            } else {
+                glDrawArrays(packet.primitive, packet.first, packet.count);
+            }
+            ++queueStats.draws;
+            queueStats.instances += static_cast<unsigned long>(packet.instanceCount);
+        }
+        begin = end;
+    }
+}
+
+RenderQueueStats& RenderQueue::stats() {
+    static RenderQueueStats queueStats;
+    return queueStats;
+}
+
+void RenderQueue::resetStats() {
+    stats() = RenderQueueStats{};
+}
@@ -1,43 +1,59 @@
 #include "RevolutionSurface.h"
 #include "Shader.h"
+#include "GLState.h"
 #include <GL/glew.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-RevolutionSurface::RevolutionSurface() : VAO(0), VBO(0), EBO(0), buffersGenerated(false) {}
+RevolutionSurface::RevolutionSurface()
+    : VAO(0), VBO(0), EBO(0), instanceVAO(0), instanceStream(GL_ARRAY_BUFFER), buffersGenerated(false) {}
 
 RevolutionSurface::~RevolutionSurface() {
     if (buffersGenerated) {
         glDeleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
         glDeleteBuffers(1, &EBO);
+        GLState::forgetVertexArray(VAO);
+        GLState::forgetBuffer(VBO);
+        GLState::forgetBuffer(EBO);
+    }
+    if (instanceVAO != 0) {
+        glDeleteVertexArrays(1, &instanceVAO);
+        GLState::forgetVertexArray(instanceVAO);
     }
 }
 
-void RevolutionSurface::generateSurface(const std::vector<MyMath::vec3>& profileCurvePoints, int numSegments, char axis) {
+bool RevolutionSurface::generateSurface(const std::vector<MyMath::vec3>& profileCurvePoints, int numSegments, char axis,
+                                        std::stop_token stop) {
     vertices.clear();
     indices.clear();
 
     if (profileCurvePoints.size() < 2 || numSegments < 3) {
         std::cerr << "RevolutionSurface: Not enough points in profile curve or too few segments." << std::endl;
         if(buffersGenerated) {
-            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
             glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+            GLState::bindVertexArray(VAO);
+            GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         }
-        return;
+        computeBounds();
+        return true;
     }
 
     float angleStep = 2.0f * static_cast<float>(M_PI) / numSegments;
 
+    vertices.reserve(vertexCount(profileCurvePoints.size(), numSegments));
+    indices.reserve(triangleCount(profileCurvePoints.size(), numSegments) * 3);
+
     for (size_t i = 0; i < profileCurvePoints.size(); ++i) {
+        if (stop.stop_requested()) return false;
         const MyMath::vec3& p = profileCurvePoints[i];
 
         for (int j = 0; j <= numSegments; ++j) {
@@ -114,55 +130,139 @@ void RevolutionSurface::generateSurface(const std::vector<MyMath::vec3>& profile
             indices.push_back(idx3);
         }
     }
+    computeBounds();
+    return true;
+}
+
+void RevolutionSurface::setMesh(std::vector<Vertex>&& meshVertices, std::vector<unsigned int>&& meshIndices,
+                                const BoundingBox& meshBounds, const BoundingSphere& meshSphere) {
+    vertices = std::move(meshVertices);
+    indices = std::move(meshIndices);
+    bounds = meshBounds;
+    boundingSphere = meshSphere;
 }
 
+// The sphere is centered on the box and sized to the farthest vertex, which is tighter than the box's half-diagonal.
+void RevolutionSurface::computeBounds() {
+    bounds = BoundingBox{};
+    boundingSphere = BoundingSphere{};
+    if (vertices.empty()) return;
+
+    bounds.min = bounds.max = vertices[0].Position;
+    for (const Vertex& v : vertices) {
+        bounds.min = MyMath::vec3(std::min(bounds.min.x, v.Position.x), std::min(bounds.min.y, v.Position.y),
+                                  std::min(bounds.min.z, v.Position.z));
+        bounds.max = MyMath::vec3(std::max(bounds.max.x, v.Position.x), std::max(bounds.max.y, v.Position.y),
+                                  std::max(bounds.max.z, v.Position.z));
+    }
+
+    boundingSphere.center = (bounds.min + bounds.max) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (const Vertex& v : vertices) {
+        radiusSquared = std::max(radiusSquared, (v.Position - boundingSphere.center).lengthSquared());
+    }
+    boundingSphere.radius = std::sqrt(radiusSquared);
+}
+
+size_t RevolutionSurface::vertexCount(size_t profilePoints, int numSegments) {
+    if (profilePoints < 2 || numSegments < 3) return 0;
+    return profilePoints * static_cast<size_t>(numSegments + 1);
+}
+
+size_t RevolutionSurface::triangleCount(size_t profilePoints, int numSegments) {
+    if (profilePoints < 2 || numSegments < 3) return 0;
+    return (profilePoints - 1) * static_cast<size_t>(numSegments) * 2;
+}
 
 void RevolutionSurface::setupBuffers() {
     if (vertices.empty() || indices.empty()) return;
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    // Regenerating the mesh reuses the GL objects; only the storage is replaced.
+    if (!buffersGenerated) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+    }
 
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    applyVertexLayout<Vertex>();
 
     buffersGenerated = true;
 }
 
-void RevolutionSurface::Draw(Shader& shader, const MyMath::mat4& modelMatrix) {
+// A second VAO over the same mesh buffers plus the instance stream, so the plain path keeps its own VAO.
+// The mesh buffers keep their names once created; the instance pointers move with the stream region.
+void RevolutionSurface::setupInstanceArray(GLintptr instanceOffset) {
+    if (instanceVAO == 0) {
+        glGenVertexArrays(1, &instanceVAO);
+        GLState::bindVertexArray(instanceVAO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+        applyVertexLayout<Vertex>();
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    }
+    GLState::bindVertexArray(instanceVAO);
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceStream.buffer);
+    applyVertexLayout<SurfaceInstance>(instanceOffset);
+}
+
+// One copy of the whole array into the stream buffer.
+void RevolutionSurface::updateInstances() {
+    instancesReady = false;
+    if (instances.empty() || !buffersGenerated) return;
+
+    GLsizeiptr bytes = static_cast<GLsizeiptr>(instances.size() * sizeof(SurfaceInstance));
+    StreamAllocation allocation = instanceStream.allocate(bytes, sizeof(SurfaceInstance));
+    if (allocation.data == nullptr) return;
+    std::memcpy(allocation.data, instances.data(), static_cast<size_t>(bytes));
+    instanceStream.flush();
+
+    setupInstanceArray(allocation.offset);
+    instancesReady = true;
+}
+
+void RevolutionSurface::submit(RenderQueue& queue, Shader& shader, GLintptr objectOffset, float depth) const {
     if (vertices.empty() || indices.empty() || !buffersGenerated) return;
 
-    shader.Use();
-    shader.setMat4("model", modelMatrix);
-    
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.vertexArray = VAO;
+    packet.objectOffset = objectOffset;
+    packet.primitive = GL_TRIANGLES;
+    packet.indexed = true;
+    packet.count = static_cast<GLsizei>(indices.size());
+    queue.submit(packet, RenderPass::Opaque, depth);
+}
+
+void RevolutionSurface::submitInstanced(RenderQueue& queue, Shader& shader, float depth) const {
+    if (vertices.empty() || indices.empty() || instances.empty() || !instancesReady) return;
+
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.vertexArray = instanceVAO;
+    packet.primitive = GL_TRIANGLES;
+    packet.indexed = true;
+    packet.count = static_cast<GLsizei>(indices.size());
+    packet.instanceCount = static_cast<GLsizei>(instances.size());
+    queue.submit(packet, RenderPass::Opaque, depth);
 }
 
 void RevolutionSurface::clearSurface(){
     vertices.clear();
     indices.clear();
+    computeBounds();
     if(buffersGenerated){
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        GLState::bindVertexArray(VAO);
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 } 
@@ -1,36 +1,33 @@
 #include "Shader.h"
+#include "GLState.h"
 #include <MyMath/mat4.h>
 #include <MyMath/vec3.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
-Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const GLchar* geometryPath) {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::string geometryCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    std::ifstream gShaderFile;
+ProgramBinaryCache* Shader::binaryCache = nullptr;
 
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+namespace {
+    const GLint MAX_SHADOWED_LOCATION = 1024;
+}
+
+Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const GLchar* geometryPath,
+               const GLchar* tessControlPath, const GLchar* tessEvaluationPath,
+               const std::vector<ShaderDefine>& defines) : Program(0), defines(defines) {
+    stages.push_back(ShaderStage{ GL_VERTEX_SHADER, "VERTEX", vertexPath, "" });
+    stages.push_back(ShaderStage{ GL_FRAGMENT_SHADER, "FRAGMENT", fragmentPath, "" });
+    if (geometryPath != nullptr)
+        stages.push_back(ShaderStage{ GL_GEOMETRY_SHADER, "GEOMETRY", geometryPath, "" });
+    if (tessControlPath != nullptr && tessEvaluationPath != nullptr) {
+        stages.push_back(ShaderStage{ GL_TESS_CONTROL_SHADER, "TESS_CONTROL", tessControlPath, "" });
+        stages.push_back(ShaderStage{ GL_TESS_EVALUATION_SHADER, "TESS_EVALUATION", tessEvaluationPath, "" });
+    }
 
     try {
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        vShaderFile.close();
-        fShaderFile.close();
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-
-        if (geometryPath != nullptr) {
-            gShaderFile.open(geometryPath);
-            std::stringstream gShaderStream;
-            gShaderStream << gShaderFile.rdbuf();
-            gShaderFile.close();
-            geometryCode = gShaderStream.str();
+        std::vector<std::string> sources = preprocessSources(&dependencies);
+        for (size_t i = 0; i < stages.size(); ++i) {
+            stages[i].source = std::move(sources[i]);
         }
     } catch (std::ifstream::failure& e) {
         std::string errorMsg = "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: Path V: ";
@@ -38,51 +35,149 @@ Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const GLcha
         errorMsg += " F: ";
         errorMsg += fragmentPath;
         if (geometryPath) { errorMsg += " G: "; errorMsg += geometryPath; }
+        if (tessControlPath) { errorMsg += " TC: "; errorMsg += tessControlPath; }
+        if (tessEvaluationPath) { errorMsg += " TE: "; errorMsg += tessEvaluationPath; }
         errorMsg += " What: ";
         errorMsg += e.what();
         throw std::ifstream::failure(errorMsg);
     }
 
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
+    pendingBuild = submitBuild();
+    this->Program = pendingBuild.program;
+    linkPending = true;
+}
+
+// Only reads the stage paths and defines, which never change after construction, so a watcher thread may call it.
+std::vector<std::string> Shader::preprocessSources(std::vector<std::string>* fileDependencies) const {
+    std::vector<std::string> sources;
+    std::vector<std::string> stageDependencies;
+    for (const ShaderStage& stage : stages) {
+        sources.push_back(ShaderPreprocessor::process(stage.path, defines, &stageDependencies));
+        if (fileDependencies == nullptr) continue;
+        for (const std::string& file : stageDependencies) {
+            if (std::find(fileDependencies->begin(), fileDependencies->end(), file) == fileDependencies->end())
+                fileDependencies->push_back(file);
+        }
+    }
+    return sources;
+}
+
+void Shader::setBinaryCache(ProgramBinaryCache* cache) {
+    binaryCache = cache;
+}
+
+bool Shader::enableParallelCompile() {
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        return true;
+    }
+    if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        return true;
+    }
+    return false;
+}
+
+// Hands every stage and the link to the driver without asking for status, so the driver is free to compile
+// in the background while other programs are being submitted.
+Shader::PendingBuild Shader::submitBuild() {
+    PendingBuild build;
+    if (binaryCache != nullptr) {
+        std::string description;
+        for (const ShaderStage& stage : stages) {
+            description += stage.label;
+            description += '\n';
+            description += stage.source;
+            description += '\0';
+        }
+        build.cacheKey = binaryCache->makeKey(description);
+        build.program = binaryCache->load(build.cacheKey);
+        if (build.program != 0) {
+            build.fromCache = true;
+            return build;
+        }
+    }
 
-    GLuint vertex, fragment;
+    for (const ShaderStage& stage : stages) {
+        const char* code = stage.source.c_str();
+        GLuint shader = glCreateShader(stage.type);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        build.shaders.push_back(shader);
+    }
 
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
+    build.program = glCreateProgram();
+    for (GLuint shader : build.shaders)
+        glAttachShader(build.program, shader);
+    if (binaryCache != nullptr)
+        glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(build.program);
+    return build;
+}
 
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
+// First status query for a submitted build; this is where a synchronous driver finally waits.
+void Shader::completeBuild(PendingBuild& build) {
+    if (build.fromCache) return;
 
-    GLuint geometry = 0;
-    if (geometryPath != nullptr) {
-        const char* gShaderCode = geometryCode.c_str();
-        geometry = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(geometry, 1, &gShaderCode, NULL);
-        glCompileShader(geometry);
-        checkCompileErrors(geometry, "GEOMETRY");
+    try {
+        for (size_t i = 0; i < build.shaders.size(); ++i)
+            checkCompileErrors(build.shaders[i], stages[i].label);
+        checkCompileErrors(build.program, "PROGRAM");
+    } catch (const std::runtime_error&) {
+        for (GLuint shader : build.shaders)
+            glDeleteShader(shader);
+        glDeleteProgram(build.program);
+        build = PendingBuild{};
+        throw;
     }
 
-    this->Program = glCreateProgram();
-    glAttachShader(this->Program, vertex);
-    glAttachShader(this->Program, fragment);
-    if (geometryPath != nullptr)
-        glAttachShader(this->Program, geometry);
-    glLinkProgram(this->Program);
-    checkCompileErrors(this->Program, "PROGRAM");
+    for (GLuint shader : build.shaders)
+        glDeleteShader(shader);
+    build.shaders.clear();
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    if (geometryPath != nullptr)
-        glDeleteShader(geometry);
+    if (binaryCache != nullptr)
+        binaryCache->store(build.cacheKey, build.program);
+}
+
+bool Shader::isLinkComplete() const {
+    if (!linkPending || pendingBuild.fromCache) return true;
+    if (!GLEW_KHR_parallel_shader_compile && !GLEW_ARB_parallel_shader_compile) return true;
+
+    GLint complete = GL_FALSE;
+    glGetProgramiv(pendingBuild.program, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+void Shader::finishLinking() {
+    if (!linkPending) return;
+    linkPending = false;
+
+    completeBuild(pendingBuild);
+    Program = pendingBuild.program;
+    pendingBuild = PendingBuild{};
+    reflectUniforms();
+}
+
+// Completes the links in the order the driver finishes them, so the status checks, cache store and reflection
+// of one program overlap with the compiles still running for the others.
+void Shader::finishLinking(std::vector<Shader*> shaders) {
+    while (!shaders.empty()) {
+        auto complete = std::partition(shaders.begin(), shaders.end(),
+                                       [](const Shader* shader) { return !shader->isLinkComplete(); });
+        if (complete == shaders.end()) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (auto it = complete; it != shaders.end(); ++it) {
+            (*it)->finishLinking();
+        }
+        shaders.erase(complete, shaders.end());
+    }
 }
 
 void Shader::Use() {
-    glUseProgram(this->Program);
+    if (linkPending) finishLinking();
+    GLState::useProgram(this->Program);
 }
 
 void Shader::checkCompileErrors(GLuint shader, std::string type) {
@@ -105,32 +200,254 @@ void Shader::checkCompileErrors(GLuint shader, std::string type) {
     }
 }
 
-void Shader::setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(Program, name.c_str()), (int)value);
+ShaderStats& Shader::stats() {
+    static ShaderStats shaderStats;
+    return shaderStats;
 }
-void Shader::setInt(const std::string &name, int value) const {
-    glUniform1i(glGetUniformLocation(Program, name.c_str()), value);
+
+void Shader::resetStats() {
+    stats() = ShaderStats{};
 }
-void Shader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(Program, name.c_str()), value);
+
+uint32_t Shader::hashName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
 }
 
-void Shader::setVec2(const std::string &name, float x, float y) const {
-    glUniform2f(glGetUniformLocation(Program, name.c_str()), x, y);
+// Active uniforms are enumerated once after linking into an open-addressing table, so lookups never reach the driver.
+void Shader::reflectUniforms() {
+    GLint activeUniforms = 0, maxNameLength = 0;
+    glGetProgramiv(Program, GL_ACTIVE_UNIFORMS, &activeUniforms);
+    glGetProgramiv(Program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    size_t capacity = 16;
+    while (capacity < static_cast<size_t>(activeUniforms) * 4) capacity *= 2;
+    uniformSlots.assign(capacity, UniformSlot{});
+
+    GLint maxLocation = -1;
+    std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1));
+    for (GLint i = 0; i < activeUniforms; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(Program, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+
+        std::string_view name(nameBuffer.data(), length);
+        GLint location = glGetUniformLocation(Program, nameBuffer.data());
+        if (location < 0) continue;
+
+        insertUniform(name, location);
+        if (name.size() > 3 && name.substr(name.size() - 3) == "[0]") {
+            insertUniform(name.substr(0, name.size() - 3), location);
+        }
+        maxLocation = std::max(maxLocation, location);
+    }
+
+    // A relinked program starts from default values, so the shadows start out empty.
+    uniformShadows.clear();
+    if (SHADER_SHADOW_UNIFORMS && maxLocation >= 0 && maxLocation < MAX_SHADOWED_LOCATION) {
+        uniformShadows.resize(static_cast<size_t>(maxLocation) + 1);
+    }
 }
 
-void Shader::setVec3(const std::string &name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(Program, name.c_str()), x, y, z);
+void Shader::insertUniform(std::string_view name, GLint location) {
+    uint32_t hash = hashName(name);
+    size_t mask = uniformSlots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        UniformSlot& slot = uniformSlots[i];
+        if (slot.location < 0) {
+            slot.name = std::string(name);
+            slot.hash = hash;
+            slot.location = location;
+            return;
+        }
+        if (slot.hash == hash && slot.name == name) return;
+    }
 }
 
-void Shader::setVec3(const std::string &name, const MyMath::vec3& value) const {
-    glUniform3fv(glGetUniformLocation(Program, name.c_str()), 1, &value.x);
+GLint Shader::findUniform(std::string_view name) const {
+    ++stats().uniformLookups;
+    if (uniformSlots.empty()) return -1;
+
+    uint32_t hash = hashName(name);
+    size_t mask = uniformSlots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        const UniformSlot& slot = uniformSlots[i];
+        if (slot.location < 0) return -1;
+        if (slot.hash == hash && slot.name == name) return slot.location;
+    }
 }
 
-void Shader::setVec4(const std::string &name, float x, float y, float z, float w) const {
-    glUniform4f(glGetUniformLocation(Program, name.c_str()), x, y, z, w);
+// Block bindings are not part of a loaded program binary, so they are assigned after the program is built
+// and remembered so a reloaded program gets them again.
+bool Shader::bindUniformBlock(const char* blockName, GLuint bindingPoint) {
+    if (linkPending) finishLinking();
+    GLuint blockIndex = glGetUniformBlockIndex(Program, blockName);
+    if (blockIndex == GL_INVALID_INDEX) return false;
+    glUniformBlockBinding(Program, blockIndex, bindingPoint);
+
+    for (BlockBinding& binding : blockBindings) {
+        if (binding.name == blockName) {
+            binding.bindingPoint = bindingPoint;
+            return true;
+        }
+    }
+    blockBindings.push_back(BlockBinding{ blockName, bindingPoint });
+    return true;
+}
+
+const std::vector<std::string>& Shader::getDependencies() const {
+    return dependencies;
+}
+
+std::vector<std::string> Shader::getSourcePaths() const {
+    std::vector<std::string> paths;
+    for (const ShaderStage& stage : stages)
+        paths.push_back(stage.path);
+    return paths;
+}
+
+// Swaps in a program built from the given stage sources, along with the files they were read from; if it fails
+// to compile or link the current program and dependencies are kept.
+bool Shader::reload(const std::vector<std::string>& sources, const std::vector<std::string>& fileDependencies) {
+    if (sources.size() != stages.size()) return false;
+
+    std::vector<std::string> previous;
+    for (size_t i = 0; i < stages.size(); ++i) {
+        previous.push_back(std::move(stages[i].source));
+        stages[i].source = sources[i];
+    }
+
+    PendingBuild build = submitBuild();
+    try {
+        completeBuild(build);
+    } catch (const std::runtime_error& e) {
+        for (size_t i = 0; i < stages.size(); ++i)
+            stages[i].source = std::move(previous[i]);
+        std::cerr << "Shader reload failed, keeping the previous program: " << e.what() << std::endl;
+        return false;
+    }
+
+    glDeleteProgram(Program);
+    GLState::forgetProgram(Program);
+    Program = build.program;
+    dependencies = fileDependencies;
+    reflectUniforms();
+    for (const BlockBinding& binding : blockBindings) {
+        GLuint blockIndex = glGetUniformBlockIndex(Program, binding.name.c_str());
+        if (blockIndex != GL_INVALID_INDEX)
+            glUniformBlockBinding(Program, blockIndex, binding.bindingPoint);
+    }
+    return true;
+}
+
+void Shader::setBool(std::string_view name, bool value) const {
+    set(getUniform<bool>(name), value);
+}
+void Shader::setInt(std::string_view name, int value) const {
+    set(getUniform<int>(name), value);
+}
+void Shader::setFloat(std::string_view name, float value) const {
+    set(getUniform<float>(name), value);
+}
+
+void Shader::setVec2(std::string_view name, float x, float y) const {
+    set(getUniform<float[2]>(name), x, y);
+}
+
+void Shader::setVec3(std::string_view name, float x, float y, float z) const {
+    set(getUniform<MyMath::vec3>(name), MyMath::vec3(x, y, z));
+}
+
+void Shader::setVec3(std::string_view name, const MyMath::vec3& value) const {
+    set(getUniform<MyMath::vec3>(name), value);
 }
 
-void Shader::setMat4(const std::string &name, const MyMath::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(Program, name.c_str()), 1, GL_FALSE, mat.value_ptr());
-} 
+void Shader::setVec4(std::string_view name, float x, float y, float z, float w) const {
+    set(getUniform<MyMath::vec4>(name), MyMath::vec4(x, y, z, w));
+}
+
+void Shader::setMat4(std::string_view name, const MyMath::mat4& mat) const {
+    set(getUniform<MyMath::mat4>(name), mat);
+}
+
+void Shader::set(UniformHandle<bool> uniform, bool value) const {
+    int data = static_cast<int>(value);
+    if (!shadowChanged(uniform.location, &data, sizeof(data))) return;
+    ++stats().uniformUploads;
+    if (directUpload()) glProgramUniform1i(Program, uniform.location, data);
+    else glUniform1i(uniform.location, data);
+}
+
+void Shader::set(UniformHandle<int> uniform, int value) const {
+    if (!shadowChanged(uniform.location, &value, sizeof(value))) return;
+    ++stats().uniformUploads;
+    if (directUpload()) glProgramUniform1i(Program, uniform.location, value);
+    else glUniform1i(uniform.location, value);
+}
+
+void Shader::set(UniformHandle<float> uniform, float value) const {
+    if (!shadowChanged(uniform.location, &value, sizeof(value))) return;
+    ++stats().uniformUploads;
+    if (directUpload()) glProgramUniform1f(Program, uniform.location, value);
+    else glUniform1f(uniform.location, value);
+}
+
+void Shader::set(UniformHandle<float[2]> uniform, float x, float y) const {
+    float data[2] = { x, y };
+    if (!shadowChanged(uniform.location, data, sizeof(data))) return;
+    ++stats().uniformUploads;
+    if (directUpload()) glProgramUniform2f(Program, uniform.location, x, y);
+    else glUniform2f(uniform.location, x, y);
+}
+
+void Shader::set(UniformHandle<MyMath::vec3> uniform, const MyMath::vec3& value) const {
+    if (!shadowChanged(uniform.location, &value.x, 3 * sizeof(float))) return;
+    ++stats().uniformUploads;
+    if (directUpload()) glProgramUniform3fv(Program, uniform.location, 1, &value.x);
+    else glUniform3fv(uniform.location, 1, &value.x);
+}
+
+void Shader::set(UniformHandle<MyMath::vec4> uniform, const MyMath::vec4& value) const {
+    if (!shadowChanged(uniform.location, &value.x, 4 * sizeof(float))) return;
+    ++stats().uniformUploads;
+    if (directUpload()) glProgramUniform4fv(Program, uniform.location, 1, &value.x);
+    else glUniform4fv(uniform.location, 1, &value.x);
+}
+
+void Shader::set(UniformHandle<MyMath::mat4> uniform, const MyMath::mat4& value) const {
+    if (!shadowChanged(uniform.location, value.value_ptr(), 16 * sizeof(float))) return;
+    ++stats().uniformUploads;
+    if (directUpload()) glProgramUniformMatrix4fv(Program, uniform.location, 1, GL_FALSE, value.value_ptr());
+    else glUniformMatrix4fv(uniform.location, 1, GL_FALSE, value.value_ptr());
+}
+
+// glProgramUniform* writes to this program without binding it, so setting uniforms never disturbs the program
+// RenderQueue::execute has bound. Without it the program is bound through GLState, which keeps that cache right.
+bool Shader::directUpload() const {
+    if (GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects) return true;
+    GLState::useProgram(Program);
+    return false;
+}
+
+// Compares against the last value sent to this location of this program and records the new one.
+// Locations that were never reflected (or -1) are passed through, since the driver ignores -1 anyway.
+bool Shader::shadowChanged(GLint location, const void* value, size_t size) const {
+    if constexpr (!SHADER_SHADOW_UNIFORMS) {
+        return true;
+    } else {
+        if (location < 0 || static_cast<size_t>(location) >= uniformShadows.size()) return true;
+
+        UniformShadow& shadow = uniformShadows[location];
+        if (shadow.valid && std::memcmp(shadow.value, value, size) == 0) {
+            ++stats().uniformSkips;
+            return false;
+        }
+        std::memcpy(shadow.value, value, size);
+        shadow.valid = true;
+        return true;
+    }
+}
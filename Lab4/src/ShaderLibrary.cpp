@@ -0,0 +1,40 @@
+#include "ShaderLibrary.h"
+#include <algorithm>
+
+namespace {
+    const GLchar* optionalPath(const std::string& path) {
+        return path.empty() ? nullptr : path.c_str();
+    }
+}
+
+Shader* ShaderLibrary::get(const ShaderVariant& variant) {
+    std::string key = makeKey(variant);
+    auto it = shaders.find(key);
+    if (it != shaders.end()) return it->second.get();
+
+    std::unique_ptr<Shader> shader = std::make_unique<Shader>(variant.vertexPath.c_str(), variant.fragmentPath.c_str(),
+                                                              optionalPath(variant.geometryPath),
+                                                              optionalPath(variant.tessControlPath),
+                                                              optionalPath(variant.tessEvaluationPath),
+                                                              variant.defines);
+    Shader* result = shader.get();
+    shaders.emplace(std::move(key), std::move(shader));
+    return result;
+}
+
+// Defines are sorted so the same set given in a different order maps to the same program.
+std::string ShaderLibrary::makeKey(const ShaderVariant& variant) {
+    std::string key = variant.vertexPath + '\n' + variant.fragmentPath + '\n' + variant.geometryPath + '\n' +
+                      variant.tessControlPath + '\n' + variant.tessEvaluationPath + '\n';
+
+    std::vector<ShaderDefine> defines = variant.defines;
+    std::sort(defines.begin(), defines.end(),
+              [](const ShaderDefine& a, const ShaderDefine& b) { return a.name < b.name; });
+    for (const ShaderDefine& define : defines) {
+        key += define.name;
+        key += '=';
+        key += define.value;
+        key += '\n';
+    }
+    return key;
+}
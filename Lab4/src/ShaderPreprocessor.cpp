@@ -0,0 +1,97 @@
+#include "ShaderPreprocessor.h"
+#include "AssetStore.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    std::string_view trimLeft(std::string_view line) {
+        size_t first = line.find_first_not_of(" \t");
+        return first == std::string_view::npos ? std::string_view() : line.substr(first);
+    }
+
+    bool isDirective(std::string_view line, std::string_view directive) {
+        line = trimLeft(line);
+        if (line.empty() || line[0] != '#') return false;
+        line = trimLeft(line.substr(1));
+        return line.substr(0, directive.size()) == directive;
+    }
+
+    bool parseInclude(std::string_view line, std::string& target) {
+        if (!isDirective(line, "include")) return false;
+        size_t open = line.find_first_of("\"<");
+        if (open == std::string_view::npos) return false;
+        size_t close = line.find_first_of("\">", open + 1);
+        if (close == std::string_view::npos) return false;
+        target = std::string(line.substr(open + 1, close - open - 1));
+        return true;
+    }
+}
+
+std::string ShaderPreprocessor::process(const std::string& path, const std::vector<ShaderDefine>& defines,
+                                        std::vector<std::string>* dependencies) {
+    std::vector<std::string> included;
+    included.push_back(std::filesystem::path(path).lexically_normal().generic_string());
+
+    std::string output;
+    expand(path, 0, &defines, included, output);
+
+    if (dependencies) *dependencies = included;
+    return output;
+}
+
+void ShaderPreprocessor::expand(const std::string& path, size_t sourceIndex, const std::vector<ShaderDefine>* defines,
+                                std::vector<std::string>& included, std::string& output) {
+    std::string source = AssetStore::load(path);
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+    std::istringstream lines(source);
+    std::string line;
+    size_t lineNumber = 0;
+    bool definesInjected = defines == nullptr || defines->empty();
+
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        std::string target;
+        if (parseInclude(line, target)) {
+            std::string includePath = (directory / target).lexically_normal().generic_string();
+            if (std::find(included.begin(), included.end(), includePath) == included.end()) {
+                included.push_back(includePath);
+                try {
+                    output += "#line 1 " + std::to_string(included.size() - 1) + "\n";
+                    expand(includePath, included.size() - 1, nullptr, included, output);
+                } catch (const std::ifstream::failure&) {
+                    throw std::ifstream::failure("cannot open #include \"" + target + "\" from " + path);
+                }
+            }
+            output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceIndex) + "\n";
+            continue;
+        }
+
+        output += line;
+        output += '\n';
+
+        if (!definesInjected && isDirective(line, "version")) {
+            for (const ShaderDefine& define : *defines) {
+                output += "#define " + define.name;
+                if (!define.value.empty()) output += " " + define.value;
+                output += '\n';
+            }
+            output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceIndex) + "\n";
+            definesInjected = true;
+        }
+    }
+
+    if (!definesInjected) {
+        std::string prefix;
+        for (const ShaderDefine& define : *defines) {
+            prefix += "#define " + define.name;
+            if (!define.value.empty()) prefix += " " + define.value;
+            prefix += '\n';
+        }
+        output = prefix + "#line 1 0\n" + output;
+    }
+}
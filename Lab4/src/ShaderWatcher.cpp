@@ -0,0 +1,257 @@
+#include "ShaderWatcher.h"
+#include "AssetStore.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const int POLL_INTERVAL_MS = 250;
+    const int SETTLE_DELAY_MS = 50;
+
+    std::string normalizePath(const std::string& path) {
+        std::error_code error;
+        std::filesystem::path absolute = std::filesystem::weakly_canonical(path, error);
+        return error ? std::filesystem::path(path).lexically_normal().string() : absolute.string();
+    }
+
+    std::vector<std::string> resolvePaths(const std::vector<std::string>& files) {
+        std::vector<std::string> paths;
+        for (const std::string& file : files)
+            paths.push_back(normalizePath(AssetStore::diskPath(file)));
+        return paths;
+    }
+}
+
+ShaderWatcher::ShaderWatcher() : pathsChanged(false), reloadReady(false), running(false), inotifyFd(-1) {}
+
+ShaderWatcher::~ShaderWatcher() {
+    stop();
+}
+
+void ShaderWatcher::watch(Shader* shader) {
+    if (shader == nullptr || running) return;
+
+    shaders.push_back(WatchedShader{ shader, resolvePaths(shader->getDependencies()) });
+}
+
+bool ShaderWatcher::start() {
+    if (running || shaders.empty()) return running;
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    for (const WatchedShader& watched : shaders) {
+        for (const std::string& path : watched.paths)
+            watchDirectoryOf(path);
+    }
+#endif
+
+    running = true;
+    worker = std::thread(&ShaderWatcher::run, this);
+    return true;
+}
+
+void ShaderWatcher::stop() {
+    if (!running) return;
+    running = false;
+    if (worker.joinable()) worker.join();
+
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+#endif
+    directories.clear();
+}
+
+// Editors often save by writing a temporary file and renaming it, so the directory is watched rather than the file.
+// The caller holds watchMutex or the worker is not running yet.
+void ShaderWatcher::watchDirectoryOf(const std::string& path) {
+#ifdef __linux__
+    if (inotifyFd < 0) return;
+
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    for (const WatchedDirectory& watched : directories)
+        if (watched.path == directory) return;
+
+    int descriptor = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (descriptor < 0) {
+        std::cerr << "ShaderWatcher: cannot watch " << directory << std::endl;
+        return;
+    }
+    directories.push_back(WatchedDirectory{ descriptor, directory });
+#else
+    (void)path;
+#endif
+}
+
+bool ShaderWatcher::isRunning() const {
+    return running;
+}
+
+void ShaderWatcher::run() {
+#ifdef __linux__
+    if (inotifyFd < 0) {
+        runPolling();
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    std::vector<std::string> changed;
+
+    while (running) {
+        pollfd descriptor{ inotifyFd, POLLIN, 0 };
+        if (poll(&descriptor, 1, POLL_INTERVAL_MS) <= 0) continue;
+
+        // Let a burst of events from one save settle before reading the files.
+        std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_DELAY_MS));
+
+        changed.clear();
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            std::lock_guard<std::mutex> lock(watchMutex);
+            for (char* ptr = buffer; ptr < buffer + length; ) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+                auto directory = std::find_if(directories.begin(), directories.end(),
+                                              [&](const WatchedDirectory& d) { return d.descriptor == event->wd; });
+                if (event->len > 0 && directory != directories.end()) {
+                    changed.push_back(normalizePath((std::filesystem::path(directory->path) / event->name).string()));
+                }
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (!changed.empty()) prepareReloads(changed);
+    }
+#else
+    runPolling();
+#endif
+}
+
+void ShaderWatcher::runPolling() {
+    std::vector<std::filesystem::file_time_type> timestamps;
+    std::vector<std::string> paths;
+    std::error_code error;
+
+    // Paths already polled keep their timestamp, so a change made while the list is rebuilt is still seen.
+    auto collectPaths = [&]() {
+        std::vector<std::string> current;
+        {
+            std::lock_guard<std::mutex> lock(watchMutex);
+            for (const WatchedShader& watched : shaders)
+                for (const std::string& path : watched.paths)
+                    if (std::find(current.begin(), current.end(), path) == current.end())
+                        current.push_back(path);
+        }
+
+        std::vector<std::filesystem::file_time_type> stamps;
+        for (const std::string& path : current) {
+            auto known = std::find(paths.begin(), paths.end(), path);
+            stamps.push_back(known != paths.end() ? timestamps[known - paths.begin()]
+                                                  : std::filesystem::last_write_time(path, error));
+        }
+        paths.swap(current);
+        timestamps.swap(stamps);
+    };
+    collectPaths();
+
+    std::vector<std::string> changed;
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+        if (pathsChanged.exchange(false)) collectPaths();
+
+        changed.clear();
+        for (size_t i = 0; i < paths.size(); ++i) {
+            std::filesystem::file_time_type stamp = std::filesystem::last_write_time(paths[i], error);
+            if (!error && stamp != timestamps[i]) {
+                timestamps[i] = stamp;
+                changed.push_back(paths[i]);
+            }
+        }
+        if (!changed.empty()) prepareReloads(changed);
+    }
+}
+
+// changedPaths holds normalized full paths; every shader depending on one of them (stage or include) gets all of
+// its sources re-read.
+void ShaderWatcher::prepareReloads(const std::vector<std::string>& changedPaths) {
+    std::vector<Shader*> affected;
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        for (const WatchedShader& watched : shaders) {
+            for (const std::string& path : watched.paths) {
+                if (std::find(changedPaths.begin(), changedPaths.end(), path) != changedPaths.end()) {
+                    affected.push_back(watched.shader);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<PendingReload> reloads;
+    for (Shader* shader : affected) {
+        // A file caught half-written (or an include that is briefly missing) just waits for the next change event.
+        try {
+            PendingReload reload{ shader, {}, {} };
+            reload.sources = shader->preprocessSources(&reload.dependencies);
+            reloads.push_back(std::move(reload));
+        } catch (const std::ifstream::failure&) {
+        }
+    }
+    if (reloads.empty()) return;
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    for (PendingReload& reload : reloads) {
+        auto existing = std::find_if(pending.begin(), pending.end(),
+                                     [&](const PendingReload& p) { return p.shader == reload.shader; });
+        if (existing != pending.end()) {
+            *existing = std::move(reload);
+        } else {
+            pending.push_back(std::move(reload));
+        }
+    }
+    reloadReady.store(true, std::memory_order_release);
+}
+
+// Called at the start of a frame on the GL thread; returns how many programs were swapped.
+int ShaderWatcher::applyPending() {
+    if (!reloadReady.load(std::memory_order_acquire)) return 0;
+
+    std::vector<PendingReload> reloads;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        reloads.swap(pending);
+        reloadReady.store(false, std::memory_order_relaxed);
+    }
+
+    int swapped = 0;
+    for (const PendingReload& reload : reloads) {
+        if (reload.shader->reload(reload.sources, reload.dependencies)) {
+            refreshPaths(reload.shader);
+            std::cout << "Reloaded shader " << reload.shader->getSourcePaths().front() << std::endl;
+            ++swapped;
+        }
+    }
+    return swapped;
+}
+
+// A reload can add or drop #includes; the shader's new dependency list replaces the watched one.
+void ShaderWatcher::refreshPaths(Shader* shader) {
+    std::vector<std::string> paths = resolvePaths(shader->getDependencies());
+
+    std::lock_guard<std::mutex> lock(watchMutex);
+    for (WatchedShader& watched : shaders) {
+        if (watched.shader != shader || watched.paths == paths) continue;
+        watched.paths = paths;
+        for (const std::string& path : watched.paths)
+            watchDirectoryOf(path);
+        pathsChanged.store(true, std::memory_order_relaxed);
+    }
+}
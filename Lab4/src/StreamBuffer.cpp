@@ -0,0 +1,158 @@
+#include "StreamBuffer.h"
+#include "GLState.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    const GLsizeiptr MIN_REGION_SIZE = 64 * 1024;
+    // Keeps every region start aligned for glBindBufferRange and attribute offsets.
+    const GLsizeiptr REGION_ALIGNMENT = 4096;
+    const GLuint64 WAIT_SLICE_NS = 1000000;
+    const GLbitfield MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    GLsizeiptr alignUp(GLsizeiptr value, GLsizeiptr alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+StreamBuffer::StreamBuffer(GLenum target) : buffer(0), target(target) {}
+
+StreamBuffer::~StreamBuffer() {
+    release();
+}
+
+bool StreamBuffer::isPersistentSupported() {
+    return persistentAllowed && (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage);
+}
+
+void StreamBuffer::setPersistentAllowed(bool allowed) {
+    persistentAllowed = allowed;
+}
+
+bool StreamBuffer::isPersistent() const {
+    return persistent;
+}
+
+void StreamBuffer::release() {
+    for (GLsync& fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (!buffersGenerated) return;
+
+    if (mapped) {
+        GLState::bindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        mapped = nullptr;
+    }
+    glDeleteBuffers(1, &buffer);
+    GLState::forgetBuffer(buffer);
+    buffer = 0;
+    buffersGenerated = false;
+}
+
+// Storage from glBufferStorage is immutable, so growing means a new buffer; every region must be idle first.
+void StreamBuffer::reallocate(GLsizeiptr minimumRegionSize) {
+    for (int i = 0; i < REGION_COUNT; ++i) waitForRegion(i);
+    release();
+
+    regionSize = std::max({ MIN_REGION_SIZE, regionSize * 2, alignUp(minimumRegionSize, REGION_ALIGNMENT) });
+    persistent = isPersistentSupported();
+
+    glGenBuffers(1, &buffer);
+    GLState::bindBuffer(target, buffer);
+    if (persistent) {
+        GLsizeiptr bytes = regionSize * REGION_COUNT;
+        glBufferStorage(target, bytes, nullptr, MAP_FLAGS);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(target, 0, bytes, MAP_FLAGS));
+        if (mapped == nullptr) {
+            glDeleteBuffers(1, &buffer);
+            GLState::forgetBuffer(buffer);
+            glGenBuffers(1, &buffer);
+            GLState::bindBuffer(target, buffer);
+            persistent = false;
+        }
+    }
+    if (!persistent) {
+        staging.resize(static_cast<size_t>(regionSize));
+        glBufferData(target, regionSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    buffersGenerated = true;
+    region = 0;
+    cursor = 0;
+    ++stats().reallocations;
+}
+
+void StreamBuffer::waitForRegion(int index) {
+    GLsync& fence = fences[index];
+    if (!fence) return;
+
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        StreamBufferStats& streamStats = stats();
+        ++streamStats.waits;
+        auto start = std::chrono::steady_clock::now();
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_SLICE_NS);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        streamStats.waitMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+// offset is relative to the start of the buffer, ready for glBindBufferRange or an attribute pointer.
+StreamAllocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+    StreamAllocation allocation;
+    if (size <= 0) return allocation;
+
+    GLsizeiptr start = alignUp(cursor, std::max<GLsizeiptr>(alignment, 1));
+    if (!buffersGenerated || start + size > regionSize) {
+        if (cursor > 0) return allocation;
+        reallocate(size);
+        start = 0;
+    }
+    if (cursor == 0 && persistent) waitForRegion(region);
+
+    cursor = start + size;
+    allocation.size = size;
+    if (persistent) {
+        allocation.offset = static_cast<GLintptr>(region) * regionSize + start;
+        allocation.data = mapped + allocation.offset;
+    } else {
+        allocation.offset = start;
+        allocation.data = staging.data() + start;
+    }
+    ++stats().allocations;
+    return allocation;
+}
+
+// Coherent mappings need no flush; the fallback replaces the buffer's storage so the upload never waits on
+// draws still reading last frame's data.
+void StreamBuffer::flush() {
+    if (persistent || cursor == 0) return;
+
+    GLState::bindBuffer(target, buffer);
+    glBufferData(target, regionSize, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, cursor, staging.data());
+}
+
+void StreamBuffer::endFrame() {
+    if (cursor == 0) return;
+
+    if (persistent) {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region = (region + 1) % REGION_COUNT;
+    }
+    cursor = 0;
+}
+
+StreamBufferStats& StreamBuffer::stats() {
+    static StreamBufferStats streamStats;
+    return streamStats;
+}
+
+void StreamBuffer::resetStats() {
+    stats() = StreamBufferStats{};
+}
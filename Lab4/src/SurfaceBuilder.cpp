@@ -0,0 +1,104 @@
+#include "SurfaceBuilder.h"
+#include "Profiler.h"
+
+SurfaceBuilder::SurfaceBuilder() : finished(nullptr), latestJob(0), deliveredJob(0), cancelledJobs(0) {}
+
+SurfaceBuilder::~SurfaceBuilder() {
+    stop();
+}
+
+void SurfaceBuilder::setOnFinished(std::function<void()> callback) {
+    if (worker.joinable()) return;
+    onFinished = std::move(callback);
+}
+
+void SurfaceBuilder::start() {
+    if (worker.joinable()) return;
+    worker = std::jthread([this](std::stop_token stop) { run(stop); });
+}
+
+void SurfaceBuilder::stop() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        runningJob.request_stop();
+    }
+    worker.request_stop();
+    worker.join();
+    delete finished.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+// Called on the render thread. The profile is copied into the job, so the caller may keep editing its own.
+uint64_t SurfaceBuilder::request(std::vector<MyMath::vec3> profile, int segments, char axis) {
+    uint64_t id = latestJob.fetch_add(1, std::memory_order_acq_rel) + 1;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        runningJob.request_stop();
+        runningJob = std::stop_source();
+
+        pendingJob.id = id;
+        pendingJob.profile = std::move(profile);
+        pendingJob.segments = segments;
+        pendingJob.axis = axis;
+        pendingJob.stop = runningJob.get_token();
+        hasPendingJob = true;
+    }
+    jobReady.notify_one();
+    return id;
+}
+
+// Single consumer: an exchange takes ownership of whatever the worker last published. A result that finished
+// just before it was superseded is dropped here rather than shown for a frame.
+std::unique_ptr<SurfaceBuilder::Result> SurfaceBuilder::takeResult() {
+    Result* result = finished.exchange(nullptr, std::memory_order_acq_rel);
+    if (result == nullptr) return nullptr;
+
+    std::unique_ptr<Result> owned(result);
+    if (owned->job != latestJob.load(std::memory_order_acquire)) return nullptr;
+    deliveredJob.store(owned->job, std::memory_order_release);
+    return owned;
+}
+
+bool SurfaceBuilder::isBusy() const {
+    return deliveredJob.load(std::memory_order_acquire) != latestJob.load(std::memory_order_acquire);
+}
+
+unsigned long SurfaceBuilder::cancelled() const {
+    return cancelledJobs.load(std::memory_order_relaxed);
+}
+
+void SurfaceBuilder::run(std::stop_token stop) {
+    // CPU-only: this surface never creates GL objects, so it may live on the worker thread.
+    RevolutionSurface mesher;
+
+    while (!stop.stop_requested()) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            if (!jobReady.wait(lock, stop, [this] { return hasPendingJob; })) break;
+            job = std::move(pendingJob);
+            hasPendingJob = false;
+        }
+
+        double startUs = Profiler::nowMicroseconds();
+        if (!mesher.generateSurface(job.profile, job.segments, job.axis, job.stop)) {
+            cancelledJobs.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        Result* result = new Result();
+        result->job = job.id;
+        result->vertices = std::move(mesher.vertices);
+        result->indices = std::move(mesher.indices);
+        result->bounds = mesher.bounds;
+        result->boundingSphere = mesher.boundingSphere;
+        result->startUs = startUs;
+        result->endUs = Profiler::nowMicroseconds();
+        mesher.vertices.clear();
+        mesher.indices.clear();
+
+        // Single producer: an older result the render thread never picked up is replaced and freed here.
+        delete finished.exchange(result, std::memory_order_acq_rel);
+        if (onFinished) onFinished();
+    }
+}
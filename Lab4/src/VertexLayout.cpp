@@ -0,0 +1,99 @@
+#include "VertexLayout.h"
+#include "Shader.h"
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+struct InputType {
+    GLint components;
+    bool floating;
+    GLuint slots = 1;
+};
+
+bool describeInput(GLenum type, InputType& input) {
+    switch (type) {
+        case GL_FLOAT:             input = { 1, true }; return true;
+        case GL_FLOAT_VEC2:        input = { 2, true }; return true;
+        case GL_FLOAT_VEC3:        input = { 3, true }; return true;
+        case GL_FLOAT_VEC4:        input = { 4, true }; return true;
+        case GL_FLOAT_MAT4:        input = { 4, true, 4 }; return true;
+        case GL_INT:               input = { 1, false }; return true;
+        case GL_INT_VEC2:          input = { 2, false }; return true;
+        case GL_INT_VEC3:          input = { 3, false }; return true;
+        case GL_INT_VEC4:          input = { 4, false }; return true;
+        case GL_UNSIGNED_INT:      input = { 1, false }; return true;
+        case GL_UNSIGNED_INT_VEC2: input = { 2, false }; return true;
+        case GL_UNSIGNED_INT_VEC3: input = { 3, false }; return true;
+        case GL_UNSIGNED_INT_VEC4: input = { 4, false }; return true;
+        default: return false;
+    }
+}
+
+}
+
+void applyVertexAttributes(const VertexAttribute* attributes, size_t count, GLsizei stride, GLintptr baseOffset) {
+    for (size_t i = 0; i < count; ++i) {
+        const VertexAttribute& attribute = attributes[i];
+        size_t slotSize = attribute.size / attribute.slots;
+        for (GLuint slot = 0; slot < attribute.slots; ++slot) {
+            GLuint location = attribute.location + slot;
+            glVertexAttribPointer(location, attribute.components, attribute.type, attribute.normalized,
+                                  stride, (void*)(baseOffset + attribute.offset + slot * slotSize));
+            glEnableVertexAttribArray(location);
+            if (attribute.divisor != 0) glVertexAttribDivisor(location, attribute.divisor);
+        }
+    }
+}
+
+// Every input the program reads must be fed by the layout with the same component count; layout entries the
+// program does not read (e.g. normals optimized out of a variant) are fine.
+void validateVertexAttributes(const Shader& shader, const VertexAttribute* attributes, size_t count,
+                              const char* layoutName) {
+    GLint activeCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(shader.Program, GL_ACTIVE_ATTRIBUTES, &activeCount);
+    glGetProgramiv(shader.Program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
+
+    std::string name(static_cast<size_t>(maxNameLength > 0 ? maxNameLength : 1), '\0');
+    for (GLint index = 0; index < activeCount; ++index) {
+        GLsizei length = 0;
+        GLint arraySize = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(shader.Program, static_cast<GLuint>(index), maxNameLength, &length, &arraySize, &type,
+                          name.data());
+        std::string inputName(name.data(), static_cast<size_t>(length));
+        if (inputName.compare(0, 3, "gl_") == 0) continue;
+
+        GLint location = glGetAttribLocation(shader.Program, inputName.c_str());
+        if (location < 0) continue;
+
+        std::string prefix = std::string("ERROR::VERTEX_LAYOUT: ") + layoutName + ": input " + inputName +
+                             " (location " + std::to_string(location) + ")";
+
+        const VertexAttribute* attribute = nullptr;
+        for (size_t i = 0; i < count; ++i) {
+            if (attributes[i].location == static_cast<GLuint>(location)) attribute = &attributes[i];
+        }
+        if (!attribute) {
+            throw std::runtime_error(prefix + " is not provided by the vertex struct");
+        }
+
+        InputType input;
+        if (!describeInput(type, input) || arraySize != 1) {
+            throw std::runtime_error(prefix + " has a type the vertex layout cannot feed");
+        }
+        if (!input.floating) {
+            throw std::runtime_error(prefix + " is an integer input, but " + attribute->name +
+                                     " is set up with glVertexAttribPointer");
+        }
+        if (input.slots != attribute->slots) {
+            throw std::runtime_error(prefix + " takes " + std::to_string(input.slots) + " locations, but " +
+                                     attribute->name + " provides " + std::to_string(attribute->slots));
+        }
+        if (input.components != attribute->components) {
+            throw std::runtime_error(prefix + " has " + std::to_string(input.components) + " components, but " +
+                                     attribute->name + " provides " + std::to_string(attribute->components));
+        }
+    }
+}
@@ -3,15 +3,42 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <array>
 #include <vector>
 #include <string>
 #include <memory>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <algorithm>
 
 #include "Shader.h"
 #include "Camera.h"
 #include "PointSet.h"
 #include "Curve.h"
 #include "RevolutionSurface.h"
+#include "PolylineSimplifier.h"
+#include "OverlayBatch.h"
+#include "ProgramBinaryCache.h"
+#include "FrameUniforms.h"
+#include "ShaderWatcher.h"
+#include "ShaderLibrary.h"
+#include "GLState.h"
+#include "AssetStore.h"
+#include "VertexLayout.h"
+#include "HeadlessContext.h"
+#include "HeadlessScene.h"
+#include "OffscreenTarget.h"
+#include "PngWriter.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+#include "Frustum.h"
+#include "StreamBuffer.h"
+#include "InputQueue.h"
+#include "InputLog.h"
+#include "SurfaceBuilder.h"
 #include <MyMath/MyMath.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -19,8 +46,30 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void window_refresh_callback(GLFWwindow* window);
 
-void processInput(GLFWwindow *window);
+bool processInput(GLFWwindow *window);
+void processInputEvents(GLFWwindow* window);
+void handleMouseButton(int button, int action, double xpos, double ypos);
+void handleKey(GLFWwindow* window, int key, int action, int mods);
+void requestRedraw();
+void queueLiveEvent(GLFWwindow* window, const InputEvent& event);
+std::vector<MyMath::vec3> buildSurfaceProfile(const std::vector<MyMath::vec3>& points);
+void reportSimplification(size_t inputPoints, size_t outputPoints);
+void syncPointEdits();
+void resolveUniforms();
+void validateVertexLayouts();
+bool initRenderer();
+void requestSurface();
+void uploadSurface(SurfaceBuilder::Result& result);
+void fillSurfaceInstances(int count);
+void cullSurfaceInstances(const Frustum& frustum);
+void submitSurface(const MyMath::vec3& viewPos, const Frustum& frustum);
+void updateProgramUniforms();
+void executeRenderQueue();
+int runHeadless(HeadlessScene& scene);
+void reportFrameStats(double now, bool rendered);
+void reportFrameTimes(const std::vector<double>& times);
 MyMath::vec3 screenToWorldCoordinates(double xpos, double ypos, int screenWidth, int screenHeight);
 
 unsigned int SCR_WIDTH = 1280;
@@ -31,6 +80,22 @@ float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 
+InputQueue inputQueue;
+// Fed by key events rather than glfwGetKey, so a replayed log holds keys down exactly as the recording did.
+std::array<bool, GLFW_KEY_LAST + 1> keysHeld{};
+
+// --record-input logs every event processInputEvents() applies, tagged with the frame it precedes.
+// --replay-input feeds such a log back instead of live input, one rendered frame per loop iteration with a
+// fixed deltaTime; --frame-times writes the time of each rendered frame as CSV.
+std::unique_ptr<InputLog> inputRecording;
+std::string inputRecordingPath;
+std::unique_ptr<InputLog> inputReplay;
+float replayDeltaTime = 1.0f / 60.0f;
+uint32_t renderedFrames = 0;
+unsigned long droppedInputEvents = 0;
+std::string frameTimesPath;
+std::vector<double> frameTimes;
+
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
@@ -44,16 +109,86 @@ bool modeChanged = false;
 std::unique_ptr<PointSet> pointSet;
 std::unique_ptr<Curve> curve;
 std::unique_ptr<RevolutionSurface> revolutionSurface;
+std::unique_ptr<SurfaceBuilder> surfaceBuilder;
+std::unique_ptr<OverlayBatch> overlay;
+bool overlayDirty = true;
+
+std::unique_ptr<ShaderLibrary> shaderLibrary;
+Shader* overlayShader = nullptr;
+Shader* surfaceShader = nullptr;
+Shader* curveTessShader = nullptr;
+
+// Surface lighting variants are specialised at compile time rather than branching in the shader.
+const ShaderVariant SURFACE_VARIANTS[] = {
+    { "shaders/surface.vert", "shaders/surface.frag", "", "", "", {} },
+    { "shaders/surface.vert", "shaders/surface.frag", "", "", "", { { "NO_SPECULAR", "" } } },
+    { "shaders/surface.vert", "shaders/surface.frag", "", "", "", { { "FLAT_SHADING", "" } } }
+};
+const ShaderVariant SURFACE_INSTANCED_VARIANTS[] = {
+    { "shaders/surface.vert", "shaders/surface.frag", "", "", "", { { "INSTANCED", "" } } },
+    { "shaders/surface.vert", "shaders/surface.frag", "", "", "", { { "INSTANCED", "" }, { "NO_SPECULAR", "" } } },
+    { "shaders/surface.vert", "shaders/surface.frag", "", "", "", { { "INSTANCED", "" }, { "FLAT_SHADING", "" } } }
+};
+const char* SURFACE_VARIANT_NAMES[] = { "smooth", "no specular", "flat" };
+const int SURFACE_VARIANT_COUNT = sizeof(SURFACE_VARIANTS) / sizeof(SURFACE_VARIANTS[0]);
+static_assert(sizeof(SURFACE_INSTANCED_VARIANTS) / sizeof(SURFACE_INSTANCED_VARIANTS[0]) == SURFACE_VARIANT_COUNT,
+              "every surface variant needs an instanced counterpart");
+Shader* surfaceShaders[SURFACE_VARIANT_COUNT] = {};
+Shader* surfaceInstancedShaders[SURFACE_VARIANT_COUNT] = {};
+Shader* surfaceInstancedShader = nullptr;
+int surfaceVariant = 0;
+std::unique_ptr<ProgramBinaryCache> programCache;
+std::unique_ptr<FrameUniformBuffer> frameUniforms;
+std::unique_ptr<ObjectUniformBuffer> objectUniforms;
+std::unique_ptr<ShaderWatcher> shaderWatcher;
+RenderQueue renderQueue;
+
+struct CurveTessUniforms {
+    UniformHandle<float[2]> viewportSize;
+    UniformHandle<float> pixelsPerSegment;
+} curveTessUniforms;
+
+bool showFrameStats = false;
+int statsFrames = 0;
+double statsStartTime = 0.0;
+std::clock_t statsStartCpu = 0;
 
-std::unique_ptr<Shader> pointShader;
-std::unique_ptr<Shader> curveShader;
-std::unique_ptr<Shader> surfaceShader;
+// On demand, a frame is drawn only after something marks it dirty: input, camera movement, a finished
+// surface or a shader reload. Otherwise the loop sleeps in glfwWaitEventsTimeout. --continuous redraws
+// every frame as before, which the profiler and frame-time measurements want.
+bool renderContinuously = false;
+bool frameDirty = true;
+const double IDLE_WAIT_SECONDS = 1.0;
+const double WATCHER_WAIT_SECONDS = 0.25;
+
+const MyMath::vec3 POINT_COLOR(1.0f, 1.0f, 0.0f);
+const MyMath::vec3 CURVE_COLOR(0.0f, 1.0f, 0.0f);
+const float CURVE_PIXELS_PER_SEGMENT = 8.0f;
+const float PICK_RADIUS = 0.03f;
+long dragIndex = -1;
 
 const int SURFACE_SEGMENTS = 32;
+const int SURFACE_PLACEHOLDER_SEGMENTS = 8;
+const int MAX_SURFACE_SEGMENTS = 1024;
+int surfaceSegments = SURFACE_SEGMENTS;
+const float SIMPLIFY_TOLERANCE = 0.005f;
+PolylineSimplifier profileSimplifier(SIMPLIFY_TOLERANCE);
+std::vector<MyMath::vec3> surfaceProfile;
 const char ROTATION_AXIS = 'Y';
 float surfaceRotationAngleX = 0.0f;
 float surfaceRotationAngleY = 0.0f;
 const float ROTATION_SPEED = 50.0f;
+const MyMath::vec3 LIGHT_POSITION(1.0f, 2.0f, 2.0f);
+const MyMath::vec3 LIGHT_COLOR(1.0f, 1.0f, 1.0f);
+const MyMath::vec3 SURFACE_COLOR(0.5f, 0.7f, 0.8f);
+const float FAR_PLANE = 100.0f;
+// 0 draws the single surface through ObjectData; otherwise a grid of copies in one instanced draw.
+int surfaceInstanceCount = 0;
+const int SURFACE_INSTANCE_GRID = 1024;
+const float SURFACE_INSTANCE_SPACING = 2.5f;
+std::vector<SurfaceInstance> sceneInstances;
+SphereBatch instanceSpheres;
+std::vector<uint32_t> visibleInstances;
 
 std::string loadShaderFromFile(const std::string& filePath) {
     std::ifstream shaderFile;
@@ -71,77 +206,201 @@ std::string loadShaderFromFile(const std::string& filePath) {
     }
 }
 
-void processInput(GLFWwindow* window) {
+// Returns true while a movement key is held, so the on-demand loop keeps drawing until it is released.
+bool processInput(GLFWwindow* window) {
+    bool moved = false;
     if (currentMode == AppMode::VIEW_SURFACE) {
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        auto held = [&](int key) {
+            bool pressed = keysHeld[key];
+            moved = moved || pressed;
+            return pressed;
+        };
+        if (held(GLFW_KEY_W))
             camera.ProcessKeyboard(FORWARD, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        if (held(GLFW_KEY_S))
             camera.ProcessKeyboard(BACKWARD, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        if (held(GLFW_KEY_A))
             camera.ProcessKeyboard(LEFT, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        if (held(GLFW_KEY_D))
             camera.ProcessKeyboard(RIGHT, deltaTime);
 
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+        if (held(GLFW_KEY_LEFT))
             surfaceRotationAngleY -= ROTATION_SPEED * deltaTime;
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+        if (held(GLFW_KEY_RIGHT))
             surfaceRotationAngleY += ROTATION_SPEED * deltaTime;
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+        if (held(GLFW_KEY_UP))
             surfaceRotationAngleX -= ROTATION_SPEED * deltaTime;
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+        if (held(GLFW_KEY_DOWN))
             surfaceRotationAngleX += ROTATION_SPEED * deltaTime;
     }
+    return moved;
+}
+
+void requestRedraw() {
+    frameDirty = true;
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
     SCR_WIDTH = width;
     SCR_HEIGHT = height;
+    requestRedraw();
+}
+
+void window_refresh_callback(GLFWwindow* window) {
+    requestRedraw();
+}
+
+// Live input is ignored while a log is replaying, apart from Escape to abort the run.
+void queueLiveEvent(GLFWwindow* window, const InputEvent& event) {
+    if (inputReplay) {
+        if (event.type == InputEventType::Key && event.code == GLFW_KEY_ESCAPE) glfwSetWindowShouldClose(window, true);
+        return;
+    }
+    inputQueue.push(event);
 }
 
+// The GLFW input callbacks only queue the event; processInputEvents() applies them once per frame.
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
-    if (currentMode == AppMode::VIEW_SURFACE) {
-        float xpos = static_cast<float>(xposIn);
-        float ypos = static_cast<float>(yposIn);
+    InputEvent event;
+    event.type = InputEventType::CursorMove;
+    event.x = xposIn;
+    event.y = yposIn;
+    queueLiveEvent(window, event);
+}
 
-        if (firstMouse) {
-            lastX = xpos;
-            lastY = ypos;
-            firstMouse = false;
-        }
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    InputEvent event;
+    event.type = InputEventType::Scroll;
+    event.x = xoffset;
+    event.y = yoffset;
+    queueLiveEvent(window, event);
+}
 
-        float xoffset = xpos - lastX;
-        float yoffset = lastY - ypos;
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    InputEvent event;
+    event.type = InputEventType::MouseButton;
+    event.code = button;
+    event.action = action;
+    event.mods = mods;
+    glfwGetCursorPos(window, &event.x, &event.y);
+    queueLiveEvent(window, event);
+}
 
-        lastX = xpos;
-        lastY = ypos;
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    InputEvent event;
+    event.type = InputEventType::Key;
+    event.code = key;
+    event.action = action;
+    event.mods = mods;
+    queueLiveEvent(window, event);
+}
+
+// Drains the queue in order. Look deltas and scroll are summed into one camera update, a drag only moves the
+// point to its latest position, and point edits reach the GPU in a single syncPointEdits() once the frame opens.
+void processInputEvents(GLFWwindow* window) {
+    float lookX = 0.0f;
+    float lookY = 0.0f;
+    float scroll = 0.0f;
+    bool dragPending = false;
+    double dragX = 0.0;
+    double dragY = 0.0;
+
+    auto applyDrag = [&]() {
+        if (!dragPending || dragIndex < 0) return;
+        MyMath::vec3 worldPos = screenToWorldCoordinates(dragX, dragY, SCR_WIDTH, SCR_HEIGHT);
+        pointSet->movePoint(static_cast<size_t>(dragIndex), worldPos);
+        dragPending = false;
+        requestRedraw();
+    };
 
-        camera.ProcessMouseMovement(xoffset, yoffset);
+    InputEvent event;
+    while (inputQueue.pop(event)) {
+        if (inputRecording) inputRecording->record(renderedFrames, event);
+        switch (event.type) {
+        case InputEventType::CursorMove:
+            if (currentMode == AppMode::VIEW_SURFACE) {
+                float xpos = static_cast<float>(event.x);
+                float ypos = static_cast<float>(event.y);
+                if (firstMouse) {
+                    lastX = xpos;
+                    lastY = ypos;
+                    firstMouse = false;
+                }
+                lookX += xpos - lastX;
+                lookY += lastY - ypos;
+                lastX = xpos;
+                lastY = ypos;
+            } else if (dragIndex >= 0) {
+                dragPending = true;
+                dragX = event.x;
+                dragY = event.y;
+            }
+            break;
+        case InputEventType::Scroll:
+            scroll += static_cast<float>(event.y);
+            break;
+        case InputEventType::MouseButton:
+            applyDrag();
+            handleMouseButton(event.code, event.action, event.x, event.y);
+            break;
+        case InputEventType::Key:
+            if (event.code >= 0 && event.code <= GLFW_KEY_LAST) keysHeld[event.code] = event.action != GLFW_RELEASE;
+            applyDrag();
+            handleKey(window, event.code, event.action, event.mods);
+            break;
+        }
     }
-}
+    applyDrag();
 
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     if (currentMode == AppMode::VIEW_SURFACE) {
-        camera.ProcessMouseScroll(static_cast<float>(yoffset));
+        if (lookX != 0.0f || lookY != 0.0f) {
+            camera.ProcessMouseMovement(lookX, lookY);
+            requestRedraw();
+        }
+        if (scroll != 0.0f) {
+            camera.ProcessMouseScroll(scroll);
+            requestRedraw();
+        }
     }
 }
 
-void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
-    if (currentMode == AppMode::INPUT_POINTS && button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-        double xpos, ypos;
-        glfwGetCursorPos(window, &xpos, &ypos);
-        MyMath::vec3 worldPos = screenToWorldCoordinates(xpos, ypos, SCR_WIDTH, SCR_HEIGHT);
-        
-        pointSet->addPoint(worldPos.x, worldPos.y);
-        pointSet->updateBuffers();
-
-        if (pointSet->getNumPoints() >= 2) {
-            curve->generateCurve(pointSet->getPoints(), 10);
-            curve->updateBuffers();
+void handleMouseButton(int button, int action, double xpos, double ypos) {
+    if (currentMode != AppMode::INPUT_POINTS) return;
+    requestRedraw();
+
+    MyMath::vec3 worldPos = screenToWorldCoordinates(xpos, ypos, SCR_WIDTH, SCR_HEIGHT);
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
+        dragIndex = pointSet->findNearestPoint(worldPos, PICK_RADIUS);
+        if (dragIndex < 0) {
+            pointSet->addPoint(worldPos.x, worldPos.y);
+        }
+    } else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE && dragIndex >= 0) {
+        pointSet->endEdit();
+        dragIndex = -1;
+    } else if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS && dragIndex < 0) {
+        long index = pointSet->findNearestPoint(worldPos, PICK_RADIUS);
+        if (index >= 0) {
+            pointSet->removePoint(static_cast<size_t>(index));
         }
     }
 }
 
+void syncPointEdits() {
+    if (!pointSet->isDirty()) return;
+    PROFILE_GPU_SCOPE("point upload");
+
+    size_t first = pointSet->getFirstModified();
+    size_t last = pointSet->getEndModified();
+    curve->updateRange(pointSet->getPoints(), first, last);
+    overlay->updatePoints(pointSet->getPoints(), POINT_COLOR, first, last);
+    if (!curve->isTessellationEnabled()) {
+        overlay->updateLineStrip(pointSet->getPoints(), CURVE_COLOR, first, last);
+    }
+    pointSet->markClean();
+    overlayDirty = true;
+}
+
 MyMath::vec3 screenToWorldCoordinates(double xpos, double ypos, int screenWidth, int screenHeight) {
     float ndcX = (static_cast<float>(xpos) / screenWidth) * 2.0f - 1.0f;
     float ndcY = 1.0f - (static_cast<float>(ypos) / screenHeight) * 2.0f;
@@ -151,13 +410,40 @@ MyMath::vec3 screenToWorldCoordinates(double xpos, double ypos, int screenWidth,
     return MyMath::vec3(ndcX * aspectRatio, ndcY, 0.0f);
 }
 
-void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+// The simplified points stay as rings; long spans get extra rings at the mean span length, which keeps the
+// quads between neighbouring rings from degenerating into slivers.
+std::vector<MyMath::vec3> buildSurfaceProfile(const std::vector<MyMath::vec3>& points) {
+    std::vector<MyMath::vec3> simplified = profileSimplifier.simplify(points);
+    if (simplified.size() < 2) return simplified;
+
+    Curve profileCurve;
+    profileCurve.generateCurve(simplified);
+    return profileCurve.resampleUniform(profileCurve.getLength() / static_cast<float>(simplified.size() - 1));
+}
+
+void reportSimplification(size_t inputPoints, size_t outputPoints) {
+    size_t verticesBefore = RevolutionSurface::vertexCount(inputPoints, surfaceSegments);
+    size_t verticesAfter = RevolutionSurface::vertexCount(outputPoints, surfaceSegments);
+    size_t trianglesBefore = RevolutionSurface::triangleCount(inputPoints, surfaceSegments);
+    size_t trianglesAfter = RevolutionSurface::triangleCount(outputPoints, surfaceSegments);
+
+    std::cout << "Profile simplified (tolerance " << profileSimplifier.getTolerance() << "): "
+              << inputPoints << " -> " << outputPoints << " points, "
+              << verticesBefore << " -> " << verticesAfter << " vertices, "
+              << trianglesBefore << " -> " << trianglesAfter << " triangles." << std::endl;
+}
+
+void handleKey(GLFWwindow* window, int key, int action, int mods) {
+    requestRedraw();
     if (action == GLFW_PRESS) {
         if (key == GLFW_KEY_ESCAPE)
             glfwSetWindowShouldClose(window, true);
         if (key == GLFW_KEY_P) {
             if (currentMode == AppMode::INPUT_POINTS) {
                 if (pointSet->getNumPoints() >= 2) {
+                    surfaceProfile = buildSurfaceProfile(pointSet->getPoints());
+                    reportSimplification(pointSet->getNumPoints(), surfaceProfile.size());
+
                     currentMode = AppMode::VIEW_SURFACE;
                     modeChanged = true;
                     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -165,7 +451,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                     std::cout << "Switched to VIEW_SURFACE mode." << std::endl;
 
                     pointSet->clearPoints();
+                    pointSet->clearHistory();
                     curve->clearCurve();
+                    overlayDirty = true;
                 } else {
                     std::cout << "Add at least 2 points to generate a surface." << std::endl;
                 }
@@ -173,27 +461,555 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
         if (key == GLFW_KEY_C && currentMode == AppMode::INPUT_POINTS) {
             pointSet->clearPoints();
-            pointSet->updateBuffers();
-            curve->clearCurve();
-            curve->updateBuffers();
             std::cout << "Cleared all points." << std::endl;
         }
+        if (currentMode == AppMode::INPUT_POINTS && (mods & GLFW_MOD_CONTROL) && dragIndex < 0) {
+            bool redo = key == GLFW_KEY_Y || (key == GLFW_KEY_Z && (mods & GLFW_MOD_SHIFT));
+            if (redo) {
+                pointSet->redo();
+            } else if (key == GLFW_KEY_Z) {
+                pointSet->undo();
+            }
+        }
+        if (key == GLFW_KEY_F) {
+            showFrameStats = !showFrameStats;
+        }
+        if (key == GLFW_KEY_L) {
+            surfaceVariant = (surfaceVariant + 1) % SURFACE_VARIANT_COUNT;
+            surfaceShader = surfaceShaders[surfaceVariant];
+            surfaceInstancedShader = surfaceInstancedShaders[surfaceVariant];
+            resolveUniforms();
+            std::cout << "Surface shading: " << SURFACE_VARIANT_NAMES[surfaceVariant] << std::endl;
+        }
+        if ((key == GLFW_KEY_EQUAL || key == GLFW_KEY_MINUS) && currentMode == AppMode::VIEW_SURFACE) {
+            int segments = key == GLFW_KEY_EQUAL ? surfaceSegments * 2 : surfaceSegments / 2;
+            segments = std::clamp(segments, 4, MAX_SURFACE_SEGMENTS);
+            if (segments != surfaceSegments) {
+                surfaceSegments = segments;
+                std::cout << "Surface segments: " << surfaceSegments << std::endl;
+                requestSurface();
+            }
+        }
+        if (key == GLFW_KEY_I) {
+            surfaceInstanceCount = surfaceInstanceCount > 0 ? 0 : SURFACE_INSTANCE_GRID;
+            std::cout << "Surface copies: " << std::max(surfaceInstanceCount, 1) << std::endl;
+        }
+        if (key == GLFW_KEY_T && currentMode == AppMode::INPUT_POINTS) {
+            if (curveTessShader) {
+                curve->setTessellationEnabled(!curve->isTessellationEnabled());
+                overlay->clearLines();
+                if (!curve->isTessellationEnabled()) {
+                    overlay->updateLineStrip(pointSet->getPoints(), CURVE_COLOR, 0, pointSet->getNumPoints());
+                }
+                overlayDirty = true;
+                std::cout << "Curve rendering: " << (curve->isTessellationEnabled() ? "tessellated spline" : "line strip") << std::endl;
+            } else {
+                std::cout << "Hardware tessellation is not available." << std::endl;
+            }
+        }
     }
 }
 
-int main() {
+void resolveUniforms() {
+    if (curveTessShader) {
+        curveTessUniforms.viewportSize = curveTessShader->getUniform<float[2]>("viewportSize");
+        curveTessUniforms.pixelsPerSegment = curveTessShader->getUniform<float>("pixelsPerSegment");
+    }
+}
+
+// Every program's vertex inputs must match the struct that feeds it, so a layout drift fails loudly.
+void validateVertexLayouts() {
+    validateVertexLayout<OverlayVertex>(*overlayShader, "OverlayVertex");
+    for (Shader* shader : surfaceShaders) {
+        validateVertexLayout<Vertex>(*shader, "Vertex");
+    }
+    for (Shader* shader : surfaceInstancedShaders) {
+        validateVertexLayout<Vertex, SurfaceInstance>(*shader, "Vertex + SurfaceInstance");
+    }
+    if (curveTessShader) {
+        validateVertexLayout<MyMath::vec3>(*curveTessShader, "curve points");
+    }
+}
+
+// Shared by the windowed and headless paths; expects a current context with GLEW initialized.
+bool initRenderer() {
+    GLState::setEnabled(GL_DEPTH_TEST, true);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    programCache = std::make_unique<ProgramBinaryCache>();
+    if (programCache->isSupported()) {
+        Shader::setBinaryCache(programCache.get());
+    }
+
+    frameUniforms = std::make_unique<FrameUniformBuffer>();
+    frameUniforms->setupBuffers();
+    objectUniforms = std::make_unique<ObjectUniformBuffer>();
+    objectUniforms->setupBuffers();
+
+    // All programs are submitted before any status is queried, so the driver can compile them concurrently.
+    Shader::enableParallelCompile();
+    auto shaderLoadStart = std::chrono::steady_clock::now();
+    shaderLibrary = std::make_unique<ShaderLibrary>();
+    try {
+        overlayShader = shaderLibrary->get({ "shaders/overlay.vert", "shaders/overlay.frag", "", "", "", {} });
+        for (int i = 0; i < SURFACE_VARIANT_COUNT; ++i) {
+            surfaceShaders[i] = shaderLibrary->get(SURFACE_VARIANTS[i]);
+            surfaceInstancedShaders[i] = shaderLibrary->get(SURFACE_INSTANCED_VARIANTS[i]);
+        }
+        surfaceShader = surfaceShaders[surfaceVariant];
+        surfaceInstancedShader = surfaceInstancedShaders[surfaceVariant];
+        if (Curve::isTessellationSupported()) {
+            try {
+                curveTessShader = shaderLibrary->get({ "shaders/curve_tess.vert", "shaders/curve.frag", "",
+                                                       "shaders/curve_tess.tesc", "shaders/curve_tess.tese", {} });
+            } catch (const std::exception& e) {
+                std::cerr << "Curve tessellation disabled: " << e.what() << std::endl;
+            }
+        }
+        // The tessellated curve program finishes on its own below, so a failure there only disables it.
+        std::vector<Shader*> required = { overlayShader };
+        required.insert(required.end(), std::begin(surfaceShaders), std::end(surfaceShaders));
+        required.insert(required.end(), std::begin(surfaceInstancedShaders), std::end(surfaceInstancedShaders));
+        Shader::finishLinking(required);
+
+        frameUniforms->attach(*overlayShader);
+        for (Shader* shader : surfaceShaders) {
+            frameUniforms->attach(*shader);
+            objectUniforms->attach(*shader);
+        }
+        for (Shader* shader : surfaceInstancedShaders) {
+            frameUniforms->attach(*shader);
+        }
+    } catch (const std::ifstream::failure& e) {
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
+        return false;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "ERROR::SHADER::COMPILATION_FAILED: " << e.what() << std::endl;
+        return false;
+    }
+
+    if (curveTessShader) {
+        try {
+            frameUniforms->attach(*curveTessShader);
+            objectUniforms->attach(*curveTessShader);
+        } catch (const std::exception& e) {
+            std::cerr << "Curve tessellation disabled: " << e.what() << std::endl;
+            curveTessShader = nullptr;
+        }
+    }
+
+    try {
+        validateVertexLayouts();
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    std::cout << "Shader programs ready in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderLoadStart).count() << " ms";
+    if (programCache->isSupported()) {
+        std::cout << " (binary cache " << programCache->getDirectory() << ": "
+                  << programCache->hits << " hits, " << programCache->misses << " misses, "
+                  << programCache->stores << " stored, " << programCache->rejected << " rejected)";
+    }
+    std::cout << std::endl;
+
+    resolveUniforms();
+    return true;
+}
+
+// Lays the copies out on a square grid in the XZ plane, each turned a little further and tinted by position.
+void fillSurfaceInstances(int count) {
+    std::vector<SurfaceInstance>& instances = sceneInstances;
+    instances.resize(static_cast<size_t>(count));
+
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+    float origin = -0.5f * (side - 1) * SURFACE_INSTANCE_SPACING;
+    MyMath::mat4 rotation = MyMath::rotate(MyMath::mat4::identity(), MyMath::radians(surfaceRotationAngleX),
+                                           MyMath::vec3(1.0f, 0.0f, 0.0f));
+    for (int i = 0; i < count; ++i) {
+        int row = i / side;
+        int column = i % side;
+        float t = static_cast<float>(i) / static_cast<float>(count);
+        MyMath::vec3 position(origin + column * SURFACE_INSTANCE_SPACING, 0.0f, origin + row * SURFACE_INSTANCE_SPACING);
+
+        SurfaceInstance& instance = instances[i];
+        instance.model = MyMath::translate(MyMath::mat4::identity(), position);
+        instance.model = MyMath::rotate(instance.model, MyMath::radians(surfaceRotationAngleY + 360.0f * t),
+                                        MyMath::vec3(0.0f, 1.0f, 0.0f));
+        instance.model = instance.model * rotation;
+        instance.color = MyMath::vec4(0.5f + 0.5f * std::cos(6.2831853f * t),
+                                      0.5f + 0.5f * std::cos(6.2831853f * (t + 0.33f)),
+                                      0.5f + 0.5f * std::cos(6.2831853f * (t + 0.67f)), 1.0f);
+    }
+}
+
+// Only the copies whose world-space bounding sphere touches the frustum reach the instance buffer.
+void cullSurfaceInstances(const Frustum& frustum) {
+    PROFILE_SCOPE("frustum culling");
+    instanceSpheres.clear();
+    instanceSpheres.reserve(sceneInstances.size());
+    for (const SurfaceInstance& instance : sceneInstances) {
+        instanceSpheres.push(revolutionSurface->boundingSphere.transformed(instance.model));
+    }
+
+    visibleInstances.clear();
+    instanceSpheres.cull(frustum, visibleInstances);
+
+    std::vector<SurfaceInstance>& visible = revolutionSurface->instances;
+    visible.clear();
+    for (uint32_t index : visibleInstances) {
+        visible.push_back(sceneInstances[index]);
+    }
+}
+
+// Tessellation runs on the builder thread. Until it delivers, the previous mesh stays on screen, or a coarse
+// placeholder built here if there is none yet.
+void requestSurface() {
+    if (surfaceProfile.size() < 2) return;
+
+    // A replay generates on this thread so the mesh arrives on the same frame every run.
+    if (inputReplay) {
+        PROFILE_SCOPE("surface generation");
+        revolutionSurface->generateSurface(surfaceProfile, surfaceSegments, ROTATION_AXIS);
+        revolutionSurface->setupBuffers();
+        return;
+    }
+
+    if (revolutionSurface->vertices.empty()) {
+        PROFILE_SCOPE("surface placeholder");
+        revolutionSurface->generateSurface(surfaceProfile, SURFACE_PLACEHOLDER_SEGMENTS, ROTATION_AXIS);
+        revolutionSurface->setupBuffers();
+    }
+    surfaceBuilder->request(surfaceProfile, surfaceSegments, ROTATION_AXIS);
+}
+
+void uploadSurface(SurfaceBuilder::Result& result) {
+    PROFILE_RECORD_CPU("surface generation", result.startUs, result.endUs);
+
+    PROFILE_GPU_SCOPE("surface upload");
+    revolutionSurface->setMesh(std::move(result.vertices), std::move(result.indices), result.bounds,
+                               result.boundingSphere);
+    revolutionSurface->setupBuffers();
+}
+
+void submitSurface(const MyMath::vec3& viewPos, const Frustum& frustum) {
+    if (revolutionSurface->vertices.empty()) return;
+
+    float depth = viewPos.length() / FAR_PLANE;
+    if (surfaceInstanceCount > 0) {
+        fillSurfaceInstances(surfaceInstanceCount);
+        cullSurfaceInstances(frustum);
+        if (revolutionSurface->instances.empty()) return;
+        {
+            PROFILE_GPU_SCOPE("instance upload");
+            revolutionSurface->updateInstances();
+        }
+        revolutionSurface->submitInstanced(renderQueue, *surfaceInstancedShader, depth);
+        return;
+    }
+
+    ObjectData object;
+    object.model = MyMath::mat4::identity();
+    object.model = MyMath::rotate(object.model, MyMath::radians(surfaceRotationAngleX), MyMath::vec3(1.0f, 0.0f, 0.0f));
+    object.model = MyMath::rotate(object.model, MyMath::radians(surfaceRotationAngleY), MyMath::vec3(0.0f, 1.0f, 0.0f));
+    object.color = MyMath::vec4(SURFACE_COLOR, 1.0f);
+
+    // The sphere test is cheap; the box is tighter for the tall, narrow parts a lathe tends to produce.
+    CullStats& cullStats = Frustum::stats();
+    ++cullStats.tested;
+    if (!frustum.intersects(revolutionSurface->boundingSphere.transformed(object.model)) ||
+        !frustum.intersects(revolutionSurface->bounds.transformed(object.model))) {
+        return;
+    }
+    ++cullStats.visible;
+
+    revolutionSurface->submit(renderQueue, *surfaceShader, objectUniforms->push(object), depth);
+}
+
+// Per-program uniforms, set once per frame before the queue runs; programs are bound only by RenderQueue::execute.
+void updateProgramUniforms() {
+    if (curveTessShader) {
+        curveTessShader->set(curveTessUniforms.viewportSize, (float)SCR_WIDTH, (float)SCR_HEIGHT);
+        curveTessShader->set(curveTessUniforms.pixelsPerSegment, CURVE_PIXELS_PER_SEGMENT);
+    }
+}
+
+void executeRenderQueue() {
+    objectUniforms->upload();
+    renderQueue.sort();
+    renderQueue.execute(*objectUniforms);
+    renderQueue.clear();
+    objectUniforms->reset();
+    if (revolutionSurface) revolutionSurface->instanceStream.endFrame();
+}
+
+// Called every loop iteration, drawn or not, so idle periods report their CPU usage too.
+void reportFrameStats(double now, bool rendered) {
+    if (rendered) ++statsFrames;
+    if (now - statsStartTime < 1.0) return;
+
+    // Process CPU time (all threads) over wall time: 100% is one core kept busy.
+    std::clock_t cpuNow = std::clock();
+    double cpuPercent = 100.0 * static_cast<double>(cpuNow - statsStartCpu) / CLOCKS_PER_SEC / (now - statsStartTime);
+    if (showFrameStats && statsFrames == 0) {
+        std::cout << "Idle: 0 frames, " << cpuPercent << "% CPU" << std::endl;
+    } else if (showFrameStats) {
+        const ShaderStats& shaderStats = Shader::stats();
+        const GLStateStats& stateStats = GLState::stats();
+        const RenderQueueStats& queueStats = RenderQueue::stats();
+        const CullStats& cullStats = Frustum::stats();
+        const StreamBufferStats& streamStats = StreamBuffer::stats();
+        const InputQueueStats& inputStats = InputQueue::stats();
+        std::cout << "Per frame: "
+                  << static_cast<double>(shaderStats.uniformLookups) / statsFrames << " uniform lookups, "
+                  << static_cast<double>(shaderStats.uniformUploads) / statsFrames << " uniform uploads, "
+                  << static_cast<double>(shaderStats.uniformSkips) / statsFrames << " unchanged uniforms skipped, "
+                  << static_cast<double>(stateStats.issued) / statsFrames << " state changes issued, "
+                  << static_cast<double>(stateStats.skipped) / statsFrames << " skipped, "
+                  << static_cast<double>(queueStats.draws) / statsFrames << " draws ("
+                  << static_cast<double>(queueStats.instances) / statsFrames << " instances), "
+                  << static_cast<double>(queueStats.programChanges) / statsFrames << " program changes, "
+                  << static_cast<double>(queueStats.vertexArrayChanges) / statsFrames << " VAO changes, "
+                  << static_cast<double>(queueStats.objectBinds) / statsFrames << " object binds, "
+                  << static_cast<double>(cullStats.visible) / statsFrames << "/"
+                  << static_cast<double>(cullStats.tested) / statsFrames << " objects visible, "
+                  << cullStats.milliseconds / statsFrames << " ms culling, "
+                  << streamStats.waits << " stream waits, "
+                  << pointSet->getHistory().size() << " edits in "
+                  << static_cast<double>(pointSet->getHistory().memoryUsage()) / 1024.0 << " KB of history, "
+                  << static_cast<double>(inputStats.queued) / statsFrames << " input events ("
+                  << inputStats.dropped << " dropped, "
+                  << statsFrames << " frames, " << cpuPercent << "% CPU)" << std::endl;
+    }
+    droppedInputEvents += InputQueue::stats().dropped;
+    Shader::resetStats();
+    GLState::resetStats();
+    RenderQueue::resetStats();
+    Frustum::resetStats();
+    StreamBuffer::resetStats();
+    InputQueue::resetStats();
+    statsFrames = 0;
+    statsStartTime = now;
+    statsStartCpu = cpuNow;
+}
+
+void reportFrameTimes(const std::vector<double>& times) {
+    FrameTimeSummary summary = HeadlessScene::summarize(times);
+    std::cout << "Frame time over " << summary.frames << " frames (ms): min " << summary.minMs
+              << ", mean " << summary.meanMs << ", median " << summary.medianMs
+              << ", p95 " << summary.p95Ms << ", p99 " << summary.p99Ms << ", max " << summary.maxMs << std::endl;
+    if (frameTimesPath.empty()) return;
+    if (HeadlessScene::writeFrameTimes(frameTimesPath, times)) {
+        std::cout << "Wrote " << frameTimesPath << std::endl;
+    } else {
+        std::cerr << "Failed to write " << frameTimesPath << std::endl;
+    }
+}
+
+// Renders the scripted scene into an FBO without a window or display and prints frame-time statistics.
+int runHeadless(HeadlessScene& scene) {
+    std::string error;
+    if (!scene.load(error)) {
+        std::cerr << "Headless scene: " << error << std::endl;
+        return -1;
+    }
+
+    HeadlessContext context;
+    if (!context.create()) {
+        std::cerr << "Failed to create headless GL context: " << context.getError() << std::endl;
+        return -1;
+    }
+
+    // A GLX build of GLEW has loaded every entry point by the time it notices there is no X display.
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (glewStatus == GLEW_ERROR_NO_GLX_DISPLAY) glewStatus = GLEW_OK;
+#endif
+    if (glewStatus != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW" << std::endl;
+        return -1;
+    }
+
+    SCR_WIDTH = scene.width;
+    SCR_HEIGHT = scene.height;
+    surfaceInstanceCount = scene.instances;
+    if (!initRenderer()) return -1;
+
+    OffscreenTarget target;
+    if (!target.setupBuffers(scene.width, scene.height)) {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        return -1;
+    }
+    target.bind();
+
+    revolutionSurface = std::make_unique<RevolutionSurface>();
+    surfaceProfile = buildSurfaceProfile(scene.profile);
+    {
+        PROFILE_SCOPE("surface generation");
+        revolutionSurface->generateSurface(surfaceProfile, scene.segments, ROTATION_AXIS);
+    }
+    {
+        PROFILE_SCOPE("surface upload");
+        revolutionSurface->setupBuffers();
+    }
+
+    std::cout << "Headless: " << scene.width << "x" << scene.height << ", " << scene.frames << " frames, "
+              << surfaceProfile.size() << " profile points, "
+              << RevolutionSurface::triangleCount(surfaceProfile.size(), scene.segments) << " triangles";
+    if (scene.instances > 0) std::cout << " x " << scene.instances << " instances";
+    std::cout << std::endl;
+
+    float aspectRatio = static_cast<float>(scene.width) / static_cast<float>(scene.height);
+    frameTimes.reserve(scene.frames);
+    std::vector<unsigned char> pixels;
+    Frustum::resetStats();
+
+    for (int frame = 0; frame < scene.frames; ++frame) {
+        PROFILE_FRAME_BEGIN();
+        PROFILE_SCOPE("frame");
+        auto frameStart = std::chrono::steady_clock::now();
+        CameraKey key = scene.cameraAt(frame);
+
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        FrameData frameData;
+        frameData.lightPos = LIGHT_POSITION;
+        frameData.lightColor = LIGHT_COLOR;
+        frameData.viewPos = key.position;
+        frameData.projection = MyMath::mat4::perspective(MyMath::radians(ZOOM), aspectRatio, 0.1f, FAR_PLANE);
+        frameData.view = MyMath::mat4::lookAt(key.position, key.target, MyMath::vec3(0.0f, 1.0f, 0.0f));
+        frameUniforms->update(frameData);
+
+        submitSurface(key.position, Frustum::fromMatrix(frameData.projection * frameData.view));
+        executeRenderQueue();
+
+        // There is no swap to pace the frame, so wait for the GPU to make the timings mean something.
+        glFinish();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+        if (scene.wantsPng(frame)) {
+            PROFILE_SCOPE("png capture");
+            target.readPixels(pixels);
+            std::string path = scene.pngPath(frame);
+            if (PngWriter::write(path, scene.width, scene.height, pixels)) {
+                std::cout << "Wrote " << path << std::endl;
+            } else {
+                std::cerr << "Failed to write " << path << std::endl;
+            }
+        }
+        PROFILE_FRAME_END();
+    }
+
+    reportFrameTimes(frameTimes);
+    const CullStats& cullStats = Frustum::stats();
+    std::cout << "Culling per frame: " << static_cast<double>(cullStats.visible) / scene.frames << "/"
+              << static_cast<double>(cullStats.tested) / scene.frames << " objects visible, "
+              << cullStats.milliseconds / scene.frames << " ms frustum test" << std::endl;
+    const StreamBufferStats& streamStats = StreamBuffer::stats();
+    std::cout << "Streaming (" << (StreamBuffer::isPersistentSupported() ? "persistent map" : "orphaned glBufferSubData")
+              << "): " << streamStats.allocations << " allocations, " << streamStats.reallocations << " reallocations, "
+              << streamStats.waits << " waits (" << streamStats.waitMilliseconds << " ms)" << std::endl;
+    Profiler::shutdown();
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    bool hotReload = false;
+    bool headless = false;
+    HeadlessScene headlessScene;
+    const char* headlessOption = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--hot-reload") == 0) {
+            hotReload = true;
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--profiler") == 0) {
+            Profiler::setEnabled(true);
+        } else if (std::strcmp(argv[i], "--profiler-interval") == 0 && i + 1 < argc) {
+            // Seconds between printed summaries; 0 prints one only at exit.
+            char* end = nullptr;
+            double seconds = std::strtod(argv[++i], &end);
+            if (end == argv[i] || *end != '\0' || !(seconds >= 0.0)) {
+                std::cerr << "Invalid value for --profiler-interval: " << argv[i] << std::endl;
+                return -1;
+            }
+            Profiler::setEnabled(true);
+            Profiler::setSummaryInterval(seconds);
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            Profiler::setEnabled(true);
+            Profiler::setTracePath(argv[++i]);
+        } else if (std::strcmp(argv[i], "--continuous") == 0) {
+            renderContinuously = true;
+        } else if (std::strcmp(argv[i], "--no-buffer-storage") == 0) {
+            StreamBuffer::setPersistentAllowed(false);
+        } else if (std::strcmp(argv[i], "--record-input") == 0 && i + 1 < argc) {
+            inputRecordingPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay-input") == 0 && i + 1 < argc) {
+            inputReplay = std::make_unique<InputLog>();
+            std::string error;
+            if (!inputReplay->load(argv[++i], error)) {
+                std::cerr << error << std::endl;
+                return -1;
+            }
+        } else if (std::strcmp(argv[i], "--replay-delta") == 0 && i + 1 < argc) {
+            replayDeltaTime = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (std::strcmp(argv[i], "--frame-times") == 0 && i + 1 < argc) {
+            frameTimesPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--asset-dir") == 0 && i + 1 < argc) {
+            AssetStore::setOverrideDirectory(argv[++i]);
+        } else {
+            const char* option = argv[i];
+            std::string error;
+            if (!headlessScene.parseArgument(argc, argv, i, error)) {
+                std::cerr << (error.empty() ? "Unknown option: " + std::string(option) : error) << std::endl;
+                return -1;
+            }
+            headlessOption = option;
+        }
+    }
+    if (headlessOption != nullptr && !headless) {
+        std::cerr << headlessOption << " requires --headless" << std::endl;
+        return -1;
+    }
+#ifdef ASSET_SOURCE_DIR
+    // Hot reload only makes sense against files on disk, so it defaults to the source tree.
+    if (hotReload && AssetStore::getOverrideDirectory().empty()) {
+        AssetStore::setOverrideDirectory(ASSET_SOURCE_DIR);
+    }
+#endif
+
+    if (headless) {
+        return runHeadless(headlessScene);
+    }
+    if (inputReplay && !inputRecordingPath.empty()) {
+        std::cerr << "--record-input and --replay-input cannot be combined" << std::endl;
+        return -1;
+    }
+    // Clicks map to world positions through the window size, so a replay opens the window it was recorded in.
+    if (inputReplay) {
+        SCR_WIDTH = inputReplay->width;
+        SCR_HEIGHT = inputReplay->height;
+    }
+
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
     }
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "OpenGL Lab 4 - Revolution Surface", nullptr, nullptr);
+    if (window == nullptr) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "OpenGL Lab 4 - Revolution Surface", nullptr, nullptr);
+    }
     if (window == nullptr) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -205,6 +1021,7 @@ int main() {
     glfwSetScrollCallback(window, scroll_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetKeyCallback(window, key_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK) {
@@ -213,101 +1030,166 @@ int main() {
         return -1;
     }
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_PROGRAM_POINT_SIZE);
-
-    try {
-        pointShader = std::make_unique<Shader>("../shaders/point.vert", "../shaders/point.frag");
-        curveShader = std::make_unique<Shader>("../shaders/curve.vert", "../shaders/curve.frag");
-        surfaceShader = std::make_unique<Shader>("../shaders/surface.vert", "../shaders/surface.frag");
-    } catch (const std::ifstream::failure& e) {
-        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
-        glfwTerminate();
-        return -1;
-    } catch (const std::runtime_error& e) {
-        std::cerr << "ERROR::SHADER::COMPILATION_FAILED: " << e.what() << std::endl;
+    if (!initRenderer()) {
         glfwTerminate();
         return -1;
     }
 
+    if (hotReload) {
+        shaderWatcher = std::make_unique<ShaderWatcher>();
+        shaderWatcher->watch(overlayShader);
+        for (Shader* shader : surfaceShaders) {
+            shaderWatcher->watch(shader);
+        }
+        for (Shader* shader : surfaceInstancedShaders) {
+            shaderWatcher->watch(shader);
+        }
+        shaderWatcher->watch(curveTessShader);
+        if (shaderWatcher->start()) {
+            std::cout << "Watching shader sources for changes" << std::endl;
+        }
+    }
+
     pointSet = std::make_unique<PointSet>();
     curve = std::make_unique<Curve>();
     revolutionSurface = std::make_unique<RevolutionSurface>();
+    surfaceBuilder = std::make_unique<SurfaceBuilder>();
+    // Wakes the on-demand loop from glfwWaitEventsTimeout; glfwPostEmptyEvent may be called from any thread.
+    surfaceBuilder->setOnFinished([] { glfwPostEmptyEvent(); });
+    surfaceBuilder->start();
+    overlay = std::make_unique<OverlayBatch>();
+    curve->setTessellationEnabled(curveTessShader != nullptr);
+
+    if (!inputRecordingPath.empty()) {
+        inputRecording = std::make_unique<InputLog>();
+        inputRecording->width = SCR_WIDTH;
+        inputRecording->height = SCR_HEIGHT;
+    }
+    if (inputReplay) {
+        // Every frame is drawn and vsync is off, so the frame times measure the work rather than the display.
+        renderContinuously = true;
+        glfwSwapInterval(0);
+        std::cout << "Replaying " << inputReplay->entries.size() << " input events over " << inputReplay->frames
+                  << " frames, " << replayDeltaTime << " s per frame" << std::endl;
+    }
 
+    statsStartCpu = std::clock();
     while (!glfwWindowShouldClose(window)) {
+        if (!renderContinuously && !frameDirty) {
+            // The shader watcher is polled, so it needs a shorter timeout than an otherwise idle window.
+            glfwWaitEventsTimeout(shaderWatcher ? WATCHER_WAIT_SECONDS : IDLE_WAIT_SECONDS);
+            // The time spent asleep must not turn into one huge camera step.
+            lastFrame = static_cast<float>(glfwGetTime());
+        }
+        if (inputReplay) {
+            if (renderedFrames >= inputReplay->frames) break;
+            while (!inputReplay->feed(renderedFrames, inputQueue)) processInputEvents(window);
+        }
+        processInputEvents(window);
+
+        if (shaderWatcher && shaderWatcher->applyPending() > 0) {
+            resolveUniforms();
+            try {
+                validateVertexLayouts();
+            } catch (const std::runtime_error& e) {
+                std::cerr << e.what() << std::endl;
+            }
+            requestRedraw();
+        }
+        std::unique_ptr<SurfaceBuilder::Result> finishedSurface = surfaceBuilder->takeResult();
+        if (finishedSurface) requestRedraw();
+
+        if (!renderContinuously && !frameDirty) {
+            reportFrameStats(glfwGetTime(), false);
+            continue;
+        }
+        frameDirty = false;
+
+        // Uploads run inside the frame so the profiler can give them GPU queries.
+        PROFILE_FRAME_BEGIN();
+        PROFILE_SCOPE("frame");
+        syncPointEdits();
+        if (finishedSurface) uploadSurface(*finishedSurface);
+        auto frameStart = std::chrono::steady_clock::now();
         float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
+        deltaTime = inputReplay ? replayDeltaTime : currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        processInput(window);
+        if (processInput(window)) requestRedraw();
 
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        FrameData frameData;
+        frameData.lightPos = LIGHT_POSITION;
+        frameData.lightColor = LIGHT_COLOR;
+        frameData.viewPos = camera.Position;
+
         if (currentMode == AppMode::INPUT_POINTS) {
             float aspectRatio = (float)SCR_WIDTH / (float)SCR_HEIGHT;
-            MyMath::mat4 ortho_projection = MyMath::mat4::orthographic(-aspectRatio, aspectRatio, -1.0f, 1.0f, -1.0f, 1.0f);
-            MyMath::mat4 identity_view = MyMath::mat4::identity();
-            MyMath::mat4 model = MyMath::mat4::identity();
-
-            pointShader->Use();
-            pointShader->setMat4("projection", ortho_projection);
-            pointShader->setMat4("view", identity_view);
-            pointShader->setMat4("model", model);
-            pointShader->setVec3("pointColor", 1.0f, 1.0f, 0.0f); 
-            pointSet->Draw(*pointShader);
-
-            if (pointSet->getNumPoints() >= 2) {
-                curveShader->Use();
-                curveShader->setMat4("projection", ortho_projection);
-                curveShader->setMat4("view", identity_view);
-                curveShader->setMat4("model", model);
-                curveShader->setVec3("curveColor", 0.0f, 1.0f, 0.0f); 
-                curve->Draw(*curveShader);
+            frameData.projection = MyMath::mat4::orthographic(-aspectRatio, aspectRatio, -1.0f, 1.0f, -1.0f, 1.0f);
+            frameData.view = MyMath::mat4::identity();
+            frameUniforms->update(frameData);
+
+            if (overlayDirty) {
+                PROFILE_GPU_SCOPE("overlay upload");
+                overlay->updateBuffers();
+                overlayDirty = false;
+            }
+
+            overlay->submit(renderQueue, *overlayShader);
+
+            if (pointSet->getNumPoints() >= 2 && curve->isTessellationEnabled()) {
+                ObjectData curveObject;
+                curveObject.model = MyMath::mat4::identity();
+                curveObject.color = MyMath::vec4(CURVE_COLOR, 1.0f);
+                curve->submit(renderQueue, *curveTessShader, objectUniforms->push(curveObject));
             }
         } else {
-            MyMath::mat4 projection = MyMath::mat4::perspective(MyMath::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-            MyMath::mat4 view = camera.GetViewMatrix();
+            frameData.projection = MyMath::mat4::perspective(MyMath::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, FAR_PLANE);
+            frameData.view = camera.GetViewMatrix();
+            frameUniforms->update(frameData);
 
             if (modeChanged) {
-                if (pointSet->getNumPoints() >= 2) {
-                    if (!curve->curvePoints.empty()){
-                         revolutionSurface->generateSurface(curve->curvePoints, SURFACE_SEGMENTS, ROTATION_AXIS);
-                    } else if (!pointSet->getPoints().empty()) {
-                        revolutionSurface->generateSurface(pointSet->getPoints(), SURFACE_SEGMENTS, ROTATION_AXIS);
-                    }
-                    
-                    if(!revolutionSurface->vertices.empty()){
-                        revolutionSurface->setupBuffers();
-                    }
-                }
+                requestSurface();
                 modeChanged = false;
             }
 
-            if (!revolutionSurface->vertices.empty()) {
-                surfaceShader->Use();
-                surfaceShader->setMat4("projection", projection);
-                surfaceShader->setMat4("view", view);
-
-                MyMath::mat4 surfaceModel = MyMath::mat4::identity();
-                surfaceModel = MyMath::rotate(surfaceModel, MyMath::radians(surfaceRotationAngleX), MyMath::vec3(1.0f, 0.0f, 0.0f));
-                surfaceModel = MyMath::rotate(surfaceModel, MyMath::radians(surfaceRotationAngleY), MyMath::vec3(0.0f, 1.0f, 0.0f));
+            submitSurface(camera.Position, Frustum::fromMatrix(frameData.projection * frameData.view));
+        }
 
-                surfaceShader->setMat4("model", surfaceModel);
-                
-                surfaceShader->setVec3("lightPos", 1.0f, 2.0f, 2.0f);
-                surfaceShader->setVec3("lightColor", 1.0f, 1.0f, 1.0f);
-                surfaceShader->setVec3("objectColor", 0.5f, 0.7f, 0.8f);
-                surfaceShader->setVec3("viewPos", camera.Position);
+        updateProgramUniforms();
+        executeRenderQueue();
 
-                revolutionSurface->Draw(*surfaceShader, surfaceModel);
-            }
-        }
+        reportFrameStats(currentFrame, true);
 
         glfwSwapBuffers(window);
+        if (inputReplay || !frameTimesPath.empty()) {
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        }
+        ++renderedFrames;
         glfwPollEvents();
+        PROFILE_FRAME_END();
+    }
+
+    if (inputRecording) {
+        inputRecording->frames = std::max(inputRecording->frames, renderedFrames);
+        if (inputRecording->save(inputRecordingPath)) {
+            std::cout << "Recorded " << inputRecording->entries.size() << " input events over "
+                      << inputRecording->frames << " frames to " << inputRecordingPath << std::endl;
+        } else {
+            std::cerr << "Failed to write " << inputRecordingPath << std::endl;
+        }
+    }
+    if (inputReplay) {
+        std::cout << "Replayed " << renderedFrames << " frames, "
+                  << droppedInputEvents + InputQueue::stats().dropped << " input events dropped" << std::endl;
     }
+    if (!frameTimes.empty()) reportFrameTimes(frameTimes);
 
+    if (shaderWatcher) shaderWatcher->stop();
+    surfaceBuilder->stop();
+    Profiler::shutdown();
     glfwTerminate();
     return 0;
 }